@@ -0,0 +1,291 @@
+#include "common.h"
+#include "util.h"
+#include "memstat.h"
+#include "ummap.h"
+#include <mpi.h>
+
+#define DATASET_PARAMS   "[size] [impl] [folder] [seg_size]"
+#define TMP_FILE         "dataset_test.tmp"
+#define MMAP_FLAGS       (MAP_SHARED | MAP_NORESERVE)
+#define POSIX_FLAGS      (O_CREAT    | O_RDWR)
+#define NUM_PASSES       5  // Default number of steady-state scans
+#define ENV_PASSES       "DATASET_PASSES"    // Steady-state scans
+#define ENV_WARM         "DATASET_WARM"      // Warm page cache (0 = Cold)
+
+enum ImplType
+{
+    IMPL_MMAP = 1, // 1 << Same values as in mstream
+    IMPL_UMMAP     // 2
+};
+
+enum PhaseType
+{
+    PHASE_FIRST = 0, // 0 << After the first scan of every process
+    PHASE_STEADY,    // 1 << After the steady-state scans
+    PHASE_NUM_TYPES
+};
+
+/**
+ * Helper method that reads every word of the dataset, returning their sum so
+ * that the scan cannot be discarded.
+ */
+static uint64_t scanDataset(const uint64_t *data, size_t size)
+{
+    const size_t num_words = size / sizeof(uint64_t);
+    uint64_t     sum       = 0;
+    
+    for (size_t i = 0; i < num_words; i++)
+    {
+        sum += data[i];
+    }
+    
+    return sum;
+}
+
+/**
+ * Helper method that records the footprint of the process, and the memory of
+ * the node consumed since the baseline (i.e., the drop of the available
+ * memory and the growth of the page cache).
+ */
+static void getFootprint(const memsample_t *baseline, size_t mem_first,
+                         memsample_t *sample, size_t *mem_used,
+                         size_t *cache_used)
+{
+    const uint64_t cached    = baseline->value[MEMSTAT_CACHED];
+    size_t         mem_avail = 0;
+    
+    memstatRead(sample);
+    mem_avail = getMemAvailable();
+    
+    *mem_used   = (mem_first > mem_avail) ? (mem_first - mem_avail) : 0;
+    *cache_used = (sample->value[MEMSTAT_CACHED] > cached) ?
+                  (sample->value[MEMSTAT_CACHED] - cached) : 0;
+}
+
+int main (int argc, char *argv[]) __CHK_FN__
+{
+    // Input parameters for the benchmark
+    size_t      size               = 0;
+    int         impl_type          = IMPL_MMAP;
+    size_t      seg_size           = sysconf(_SC_PAGESIZE);
+    
+    // Auxiliary variables required for the test
+    const char  *phase_name[2]     = { "first", "steady" };
+    int         rank               = 0;
+    int         num_procs          = 0;
+    int         local_rank         = 0;
+    int         num_local          = 0;
+    int         leader             = 0;
+    MPI_Comm    comm_node          = MPI_COMM_NULL;
+    char        filename[PATH_MAX] = { 0 };
+    int         fd                 = -1;
+    char        *baseptr           = NULL;
+    uint32_t    num_passes         = NUM_PASSES;
+    int         is_warm            = FALSE;
+    uint64_t    sum                = 0;
+    double      elapsed[2]         = { 0.0 };
+    size_t      mem_first          = 0;
+    size_t      mem_used[2]        = { 0 };
+    size_t      cache_used[2]      = { 0 };
+    double      bandwidth          = 0.0;
+    double      bandwidth_all      = 0.0;
+    double      first_all          = 0.0;
+    memsample_t baseline           = { { 0 } };
+    memsample_t sample[2]          = { { { 0 } } };
+    memsample_t sample_node[2]     = { { { 0 } } };
+    timespec_t  start              = { 0 };
+    timespec_t  stop               = { 0 };
+    
+    // Check if the number of parameters match the expected
+    if (argc < 4 || argc > 5)
+    {
+        fprintf(stderr, "Error: The number of parameters is incorrect!\n");
+        fprintf(stderr, "Use: %s %s\n", argv[0], DATASET_PARAMS);
+        return -1;
+    }
+    
+    // Initialize MPI and retrieve the rank of the process
+    CHKPRINT(MPI_Init(&argc, &argv));
+    CHKPRINT(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    CHKPRINT(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
+    
+    // Retrieve the benchmark settings
+    sscanf(argv[1], "%zu", &size);
+    sscanf(argv[2], "%d",  &impl_type);
+    
+    if (argc == 5)
+    {
+        sscanf(argv[4], "%zu", &seg_size);
+    }
+    
+    num_passes = getEnvSize(ENV_PASSES, NUM_PASSES);
+    is_warm    = getEnvSize(ENV_WARM, FALSE);
+    
+    // The dataset is scanned in words and mapped whole by every process
+    if (size == 0 || (size % sysconf(_SC_PAGESIZE)) || num_passes == 0 ||
+        (impl_type != IMPL_MMAP && impl_type != IMPL_UMMAP))
+    {
+        fprintf(stderr, "Error: The size must be page-aligned, with at least "
+                        "one pass and MMAP/UMMAP!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // Group the processes of each node, which share a single file (i.e., the
+    // first process of the node populates it)
+    CHKPRINT(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                                 MPI_INFO_NULL, &comm_node));
+    CHKPRINT(MPI_Comm_rank(comm_node, &local_rank));
+    CHKPRINT(MPI_Comm_size(comm_node, &num_local));
+    
+    leader = rank;
+    CHKPRINT(MPI_Bcast(&leader, 1, MPI_INT, 0, comm_node));
+    
+    // Create the temp. folder according to the settings
+    if (rank == 0)
+    {
+        CHKPRINT(createDir(argv[3]));
+    }
+    
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    sprintf(filename, "%s/%s.%d", argv[3], TMP_FILE, leader);
+    
+    if (local_rank == 0)
+    {
+        CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE, size, &fd));
+        CHKPRINT(setCacheState(fd, 0, size, ((is_warm) ? CACHE_WARM :
+                                                         CACHE_COLD)));
+        CHKPRINT(close(fd));
+    }
+    
+    // Record the baseline of the node before any process maps the dataset
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    memstatRead(&baseline);
+    mem_first = getMemAvailable();
+    
+    CHKPRINT(openFile(filename, O_RDONLY, FALSE, 0, &fd));
+    
+    if (impl_type == IMPL_UMMAP)
+    {
+        CHKPRINT(ummap(size, seg_size, PROT_READ, fd, 0, UINT_MAX, TRUE, 0,
+                       (void **)&baseptr));
+    }
+    else
+    {
+        CHKPRINT(mapMemory(size, PROT_READ, MMAP_FLAGS, fd, 0, 0,
+                           (void **)&baseptr));
+    }
+    
+    // Time the first scan of the dataset (i.e., every process faults in the
+    // whole mapping at the same time)
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    clock_gettime(CLOCK_REALTIME, &start);
+    sum += scanDataset((const uint64_t *)baseptr, size);
+    clock_gettime(CLOCK_REALTIME, &stop);
+    elapsed[PHASE_FIRST] = getElapsed(start, stop, TSUNIT_SEC);
+    
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    getFootprint(&baseline, mem_first, &sample[PHASE_FIRST],
+                 &mem_used[PHASE_FIRST], &cache_used[PHASE_FIRST]);
+    
+    // Time the steady-state scans (i.e., the dataset is already resident)
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    clock_gettime(CLOCK_REALTIME, &start);
+    
+    for (uint32_t pass = 0; pass < num_passes; pass++)
+    {
+        sum += scanDataset((const uint64_t *)baseptr, size);
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &stop);
+    elapsed[PHASE_STEADY] = getElapsed(start, stop, TSUNIT_SEC);
+    bandwidth             = ((size * num_passes) / elapsed[PHASE_STEADY]) /
+                            1048576.0;
+    
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    getFootprint(&baseline, mem_first, &sample[PHASE_STEADY],
+                 &mem_used[PHASE_STEADY], &cache_used[PHASE_STEADY]);
+    
+    // Accumulate the footprint of the processes of each node
+    CHKPRINT(MPI_Reduce(sample, sample_node,
+                        (PHASE_NUM_TYPES * MEMSTAT_NUM_FIELDS), MPI_UINT64_T,
+                        MPI_SUM, 0, comm_node));
+    
+    // Print the result (in order)
+    for (int drank = 0; drank < num_procs; drank++)
+    {
+        CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+        
+        if (drank == rank)
+        {
+            const uint64_t *value = sample[PHASE_STEADY].value;
+            
+            printf("%d;%d;%d; %zu;%zu;%d;%u; %lf;%lf;%lf; "
+                   "%lf;%lf;%lf;%lf; %lu\n", rank, num_procs, local_rank,
+                   size, seg_size, impl_type, num_passes,
+                   elapsed[PHASE_FIRST], elapsed[PHASE_STEADY], bandwidth,
+                   value[MEMSTAT_RSS]  / 1048576.0,
+                   value[MEMSTAT_PSS]  / 1048576.0,
+                   value[MEMSTAT_ANON] / 1048576.0,
+                   value[MEMSTAT_FILE] / 1048576.0, sum);
+            
+            // The memory of the node is printed by its first process (i.e.,
+            // the page cache is shared, instead of accumulated)
+            for (int phase = 0; phase < PHASE_NUM_TYPES && local_rank == 0;
+                 phase++)
+            {
+                value = sample_node[phase].value;
+                
+                printf("node;%d;%s;%d; %lf;%lf; %lf;%lf;%lf;%lf\n", rank,
+                       phase_name[phase], num_local,
+                       mem_used[phase] / 1048576.0,
+                       cache_used[phase] / 1048576.0,
+                       value[MEMSTAT_RSS]  / 1048576.0,
+                       value[MEMSTAT_PSS]  / 1048576.0,
+                       value[MEMSTAT_ANON] / 1048576.0,
+                       value[MEMSTAT_FILE] / 1048576.0);
+            }
+        }
+    }
+    
+    // Summarize the first scan (i.e., the slowest process) and the aggregated
+    // steady-state bandwidth of all the processes
+    CHKPRINT(MPI_Reduce(&elapsed[PHASE_FIRST], &first_all, 1, MPI_DOUBLE,
+                        MPI_MAX, 0, MPI_COMM_WORLD));
+    CHKPRINT(MPI_Reduce(&bandwidth, &bandwidth_all, 1, MPI_DOUBLE, MPI_SUM, 0,
+                        MPI_COMM_WORLD));
+    
+    if (rank == 0)
+    {
+        printf("all;%d;%d; %lf;%lf\n", num_procs, impl_type, first_all,
+               bandwidth_all);
+    }
+    
+    // Release the resources
+    if (impl_type == IMPL_UMMAP)
+    {
+        CHKPRINT(umunmap(baseptr, FALSE));
+    }
+    else
+    {
+        CHKPRINT(unmapMemory(baseptr, size, 0));
+    }
+    
+    CHKPRINT(close(fd));
+    CHKPRINT(MPI_Comm_free(&comm_node));
+    
+    // Force all processes to wait before finalizing the MPI session
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    
+#if !VERIFY_OUTPUT
+    // Delete the temp. folder containing the files
+    if (rank == 0)
+    {
+        CHKPRINT(deleteDir(argv[3]));
+    }
+#endif
+    
+    // Finalize the MPI session
+    CHKPRINT(MPI_Finalize());
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
@@ -0,0 +1,424 @@
+#include "common.h"
+#include "util.h"
+#include "hist.h"
+#include "uffd.h"
+#include "ummap.h"
+#include <pthread.h>
+#include <mpi.h>
+
+#define MAPCOST_PARAMS   "[size] [impl] [num_maps] [folder] [seg_size]"
+#define TMP_FILE         "mapcost_test.tmp"
+#define PROT_FULL        (PROT_READ   | PROT_WRITE)
+#define MMAP_FLAGS       (MAP_SHARED  | MAP_NORESERVE)
+#define MMAP_FLAGS_M     (MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS)
+#define POSIX_FLAGS      (O_CREAT     | O_RDWR)
+#define NUM_LIVE         32 // Buckets of live mappings (powers of two)
+#define ENV_THREADS      "MAPCOST_THREADS"   // Number of threads per process
+#define ENV_SIZES        "MAPCOST_SIZES"     // Sweep the size (0 = No)
+#define ENV_SWEEP        "MAPCOST_SWEEP"     // Sweep seg_size (0 = No)
+
+enum ImplType
+{
+    IMPL_MEM = 0, // 0 << Anonymous mmap / munmap
+    IMPL_MMAP,    // 1 << File-backed mmap / munmap (reference)
+    IMPL_UMMAP,   // 2
+    IMPL_UFFD = 7 // 7 << Same value as in mstream
+};
+
+enum OpType
+{
+    OP_MAP = 0, // 0 << Creation of the mapping
+    OP_FAULT,   // 1 << First write fault on the new mapping
+    OP_UNMAP,   // 2 << Release of the mapping
+    OP_NUM_TYPES
+};
+
+/**
+ * Structure that contains the settings and the results of the test for each
+ * of the threads of the process. The latencies are accumulated per bucket of
+ * live mappings of the thread (i.e., the mapping i falls in the bucket
+ * log2(i + 1)).
+ */
+typedef struct
+{
+    int               impl_type;
+    size_t            size;
+    size_t            seg_size;
+    uint32_t          num_maps;
+    int               fd;
+    char              **baseptr;
+    uffd_t            **uffd;
+    hist_t            *hist;
+    pthread_barrier_t *barrier;
+    timespec_t        start[2];
+    timespec_t        stop[2];
+    uint64_t          time[OP_NUM_TYPES][NUM_LIVE];
+    uint32_t          count[NUM_LIVE];
+    int               result;
+} mc_thread_t;
+
+/**
+ * Helper method that returns the bucket of live mappings of the given index.
+ */
+static inline uint32_t getBucket(uint32_t index)
+{
+    return 63 - __builtin_clzll((uint64_t)index + 1);
+}
+
+/**
+ * Helper method that times a single operation and records its latency.
+ */
+static inline void recordOp(mc_thread_t *mcthread, int op, uint32_t index,
+                            uint64_t start)
+{
+    const uint64_t elapsed = histGetTime() - start;
+    
+    mcthread->time[op][getBucket(index)] += elapsed;
+    histRecord(&mcthread->hist[op], elapsed);
+}
+
+/**
+ * Helper method that returns the average latency of the operation over every
+ * bucket of live mappings, in microseconds.
+ */
+static double getMean(const mc_thread_t *mcthread, int op)
+{
+    uint64_t time  = 0;
+    uint64_t count = 0;
+    
+    for (uint32_t live = 0; live < NUM_LIVE; live++)
+    {
+        time  += mcthread->time[op][live];
+        count += mcthread->count[live];
+    }
+    
+    return (count > 0) ? (time / (count * 1000.0)) : 0.0;
+}
+
+/**
+ * Helper method that creates the mappings of the thread one by one, touching
+ * the first page of each of them, and then releases them in reverse order
+ * (i.e., the number of live mappings grows and shrinks in both phases).
+ */
+int launchMappings(mc_thread_t *mcthread) __CHK_FN__
+{
+    const int    impl_type = mcthread->impl_type;
+    const size_t size      = mcthread->size;
+    uint64_t     op_start  = 0;
+    
+    pthread_barrier_wait(mcthread->barrier);
+    clock_gettime(CLOCK_REALTIME, &mcthread->start[0]);
+    
+    for (uint32_t i = 0; i < mcthread->num_maps; i++)
+    {
+        void **addr = (void **)&mcthread->baseptr[i];
+        
+        op_start = histGetTime();
+        
+        switch (impl_type)
+        {
+            case IMPL_UMMAP:
+                CHK(ummap(size, mcthread->seg_size, PROT_FULL, mcthread->fd,
+                          (i * size), UINT_MAX, FALSE, 0, addr)); break;
+            case IMPL_UFFD:
+                CHK(uffdMap(size, mcthread->seg_size, mcthread->fd, (i * size),
+                            0, FALSE, UFFD_PTYPE_FIFO, &mcthread->uffd[i],
+                            addr)); break;
+            case IMPL_MMAP:
+                CHK(mapMemory(size, PROT_FULL, MMAP_FLAGS, mcthread->fd,
+                              (i * size), 0, addr)); break;
+            default: // IMPL_MEM
+                CHK(mapMemory(size, PROT_FULL, MMAP_FLAGS_M, -1, 0, 0, addr));
+        }
+        
+        recordOp(mcthread, OP_MAP, i, op_start);
+        
+        // The fault has to locate the new mapping among the live ones
+        op_start = histGetTime();
+        mcthread->baseptr[i][0] = 21;
+        recordOp(mcthread, OP_FAULT, i, op_start);
+        
+        mcthread->count[getBucket(i)]++;
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &mcthread->stop[0]);
+    pthread_barrier_wait(mcthread->barrier);
+    clock_gettime(CLOCK_REALTIME, &mcthread->start[1]);
+    
+    for (uint32_t i = mcthread->num_maps; i-- > 0;)
+    {
+        op_start = histGetTime();
+        
+        switch (impl_type)
+        {
+            case IMPL_UMMAP:
+                CHK(umunmap(mcthread->baseptr[i], FALSE)); break;
+            case IMPL_UFFD:
+                CHK(uffdUnmap(mcthread->uffd[i], FALSE)); break;
+            default: // IMPL_MEM + IMPL_MMAP
+                CHK(unmapMemory(mcthread->baseptr[i], size, 0));
+        }
+        
+        recordOp(mcthread, OP_UNMAP, i, op_start);
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &mcthread->stop[1]);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that launches the test on the secondary threads.
+ */
+void *launchThread(void *arg)
+{
+    mc_thread_t *mcthread = (mc_thread_t *)arg;
+    
+    mcthread->result = launchMappings(mcthread);
+    
+    return NULL;
+}
+
+int main (int argc, char *argv[]) __CHK_FN__
+{
+    // Input parameters for the benchmark
+    size_t       size               = 0;
+    int          impl_type          = IMPL_MEM;
+    uint32_t     num_maps           = 0;
+    size_t       seg_size           = sysconf(_SC_PAGESIZE);
+    
+    // Auxiliary variables required for the test
+    const size_t page_size          = sysconf(_SC_PAGESIZE); // Fixed
+    const char   *op_name[3]        = { "map", "fault", "unmap" };
+    int          rank               = 0;
+    int          num_procs          = 0;
+    char         filename[PATH_MAX] = { 0 };
+    uint32_t     num_threads        = 1;
+    int          is_file            = FALSE;
+    size_t       size_first         = 0;
+    size_t       seg_first          = 0;
+    mc_thread_t  *mcthread          = NULL;
+    pthread_t    *threads           = NULL;
+    pthread_barrier_t barrier;
+    
+    // Check if the number of parameters match the expected
+    if (argc < 5 || argc > 6)
+    {
+        fprintf(stderr, "Error: The number of parameters is incorrect!\n");
+        fprintf(stderr, "Use: %s %s\n", argv[0], MAPCOST_PARAMS);
+        return -1;
+    }
+    
+    // Initialize MPI and retrieve the rank of the process
+    CHKPRINT(MPI_Init(&argc, &argv));
+    CHKPRINT(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    CHKPRINT(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
+    
+    // Retrieve the benchmark settings
+    sscanf(argv[1], "%zu", &size);
+    sscanf(argv[2], "%d",  &impl_type);
+    sscanf(argv[3], "%u",  &num_maps);
+    
+    if (argc == 6)
+    {
+        sscanf(argv[5], "%zu", &seg_size);
+    }
+    
+    num_threads = getEnvSize(ENV_THREADS, 1);
+    is_file     = (impl_type != IMPL_MEM);
+    
+    // Sweep the size and / or the segment size from a single page, if
+    // requested (i.e., only the segments that fit in the mapping)
+    size_first  = (getEnvSize(ENV_SIZES, FALSE)) ? page_size : size;
+    seg_first   = (getEnvSize(ENV_SWEEP, FALSE) &&
+                   (impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD)) ?
+                  page_size : seg_size;
+    
+    // The mappings of each thread are placed at consecutive offsets of the
+    // same file, so that their size must be page-aligned
+    if (size == 0 || (size % page_size) || num_maps < num_threads ||
+        num_threads == 0)
+    {
+        fprintf(stderr, "Error: The size must be page-aligned, with at least "
+                        "one mapping per thread!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // Create the temp. folder according to the settings
+    if (rank == 0 && is_file)
+    {
+        CHKPRINT(createDir(argv[4]));
+    }
+    
+    for (size_t size_s = size_first; size_s <= size; size_s <<= 1)
+    {
+        for (size_t seg = seg_first; seg <= seg_size && seg <= size_s;
+             seg <<= 1)
+        {
+            // Force all processes to wait before allocating
+            CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+            
+            // Split the mappings among the threads, each with its own file
+            mcthread = (mc_thread_t *)calloc(num_threads, sizeof(mc_thread_t));
+            threads  = (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+            CHKPRINT(pthread_barrier_init(&barrier, NULL, num_threads));
+            
+            for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+            {
+                mc_thread_t    *mct      = &mcthread[thread_id];
+                const uint32_t maps_last = (num_maps * (thread_id + 1) /
+                                            num_threads);
+                
+                mct->impl_type = impl_type;
+                mct->size      = size_s;
+                mct->seg_size  = seg;
+                mct->num_maps  = maps_last - (num_maps * thread_id /
+                                              num_threads);
+                mct->fd        = -1;
+                mct->baseptr   = (char **)calloc(mct->num_maps,
+                                                 sizeof(char *));
+                mct->uffd      = (uffd_t **)calloc(mct->num_maps,
+                                                   sizeof(uffd_t *));
+                mct->hist      = (hist_t *)calloc(OP_NUM_TYPES,
+                                                  sizeof(hist_t));
+                mct->barrier   = &barrier;
+                
+                if (is_file)
+                {
+                    sprintf(filename, "%s/%s.%d.%u", argv[4], TMP_FILE, rank,
+                            thread_id);
+                    CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE,
+                                      (mct->num_maps * size_s), &mct->fd));
+                }
+            }
+            
+            // Force all processes to wait before starting the test
+            CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+            
+            // Launch the test (the main thread acts as the first thread)
+            for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+            {
+                CHKPRINT(pthread_create(&threads[thread_id], NULL,
+                                        launchThread, &mcthread[thread_id]));
+            }
+            
+            CHKPRINT(launchMappings(&mcthread[0]));
+            
+            for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+            {
+                mc_thread_t *mct = &mcthread[thread_id];
+                
+                CHKPRINT(pthread_join(threads[thread_id], NULL));
+                CHKPRINT(mct->result);
+                
+                // Accumulate the results of the thread into the main thread
+                for (int op = 0; op < OP_NUM_TYPES; op++)
+                {
+                    histMerge(&mcthread[0].hist[op], &mct->hist[op]);
+                    
+                    for (uint32_t live = 0; live < NUM_LIVE; live++)
+                    {
+                        mcthread[0].time[op][live] += mct->time[op][live];
+                    }
+                }
+                
+                for (uint32_t live = 0; live < NUM_LIVE; live++)
+                {
+                    mcthread[0].count[live] += mct->count[live];
+                }
+            }
+            
+            CHKPRINT(pthread_barrier_destroy(&barrier));
+            
+            // Print the result (in order)
+            for (int drank = 0; drank < num_procs; drank++)
+            {
+                CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+                
+                if (drank == rank)
+                {
+                    const mc_thread_t *mct = &mcthread[0];
+                    
+                    printf("%d;%d; %zu;%zu;%d;%u;%u; %lf;%lf;%lf; %lf;%lf\n",
+                           rank, num_procs, size_s, seg, impl_type, num_maps,
+                           num_threads,
+                           getMean(mct, OP_MAP), getMean(mct, OP_FAULT),
+                           getMean(mct, OP_UNMAP),
+                           getElapsed(mct->start[0], mct->stop[0], TSUNIT_SEC),
+                           getElapsed(mct->start[1], mct->stop[1],
+                                      TSUNIT_SEC));
+                    
+                    // Print the average latencies, given the number of live
+                    // mappings of each thread (i.e., from 2^live to
+                    // 2^(live + 1) - 1)
+                    for (uint32_t live = 0; live < NUM_LIVE &&
+                                            mct->count[live] > 0; live++)
+                    {
+                        const double count = mct->count[live] * 1000.0;
+                        
+                        printf("live;%d;%u;%u; %lf;%lf;%lf\n", rank,
+                               (1U << live), mct->count[live],
+                               mct->time[OP_MAP][live]   / count,
+                               mct->time[OP_FAULT][live] / count,
+                               mct->time[OP_UNMAP][live] / count);
+                    }
+                }
+            }
+            
+            // Merge the histograms of all the processes and print the
+            // percentiles
+            for (int op = 0; op < OP_NUM_TYPES; op++)
+            {
+                hist_t *hist_all = (hist_t *)calloc(1, sizeof(hist_t));
+                
+                CHKPRINT(histReduce(&mcthread[0].hist[op], hist_all, 0,
+                                    MPI_COMM_WORLD));
+                
+                if (rank == 0)
+                {
+                    printf("hist;%s; %lu; %lf;%lf;%lf;%lf;%lf\n", op_name[op],
+                           (unsigned long)hist_all->count,
+                           histPercentile(hist_all, 50.0) / 1000.0,
+                           histPercentile(hist_all, 90.0) / 1000.0,
+                           histPercentile(hist_all, 99.0) / 1000.0,
+                           histPercentile(hist_all, 99.9) / 1000.0,
+                           hist_all->max / 1000.0);
+                }
+                
+                free(hist_all);
+            }
+            
+            // Release the resources
+            for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+            {
+                if (mcthread[thread_id].fd >= 0)
+                {
+                    CHKPRINT(close(mcthread[thread_id].fd));
+                }
+                
+                free(mcthread[thread_id].baseptr);
+                free(mcthread[thread_id].uffd);
+                free(mcthread[thread_id].hist);
+            }
+            
+            free(threads);
+            free(mcthread);
+        }
+    }
+    
+    // Force all processes to wait before finalizing the MPI session
+    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    
+#if !VERIFY_OUTPUT
+    // Delete the temp. folder containing the files
+    if (rank == 0 && is_file)
+    {
+        CHKPRINT(deleteDir(argv[4]));
+    }
+#endif
+    
+    // Finalize the MPI session
+    CHKPRINT(MPI_Finalize());
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
@@ -1,8 +1,25 @@
 
 #include "common.h"
 #include "util.h"
+#include "hist.h"
+#include "trace.h"
+#include "dist.h"
+#include "uring.h"
+#include "uffd.h"
+#include "perf.h"
+#include "kernel.h"
+#include "sampler.h"
+#include "rma.h"
+#include "mpiio.h"
+#include "stats.h"
+#include "record.h"
+#include "numa.h"
+#include "memstat.h"
+#include "prefetch.h"
 #include "ummap.h"
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <pthread.h>
 #include <mpi.h>
 #ifdef MPI_SWIN_ENABLED
 // Include the MPI Storage Windows header
@@ -14,7 +31,7 @@
 #define TMP_FOLDER     "tmp"
 #define NUM_ITER_INIT  0
 #define NUM_ITER       10
-#define NUM_ITER_TOTAL (NUM_ITER_INIT + NUM_ITER)
+#define OUTLIER_Z      3.5 // Modified z-score (Iglewicz and Hoaglin)
 #define PROT_FULL      (PROT_READ       | PROT_WRITE)
 #define MMAP_FLAGS     (MAP_SHARED      | MAP_NORESERVE)
 #define MMAP_FLAGS_M   (MAP_PRIVATE     | MAP_NORESERVE | MAP_ANONYMOUS)
@@ -24,12 +41,69 @@
 #define RAND_OFFSET(seed, chunk_size, size) \
     (((off_t)rand_r(&seed) * chunk_size) % size)
 
+// Elements of each STREAM array (i.e., multiple of a cache line)
+#define STREAM_ELEMS(size) \
+    ((((size) / (3 * sizeof(double))) >> 3) << 3)
+
+// Optional settings of the benchmark (i.e., environment variables)
+#define ENV_HIST        "MSTREAM_HIST"        // Latency histograms (0 = No)
+#define ENV_THREADS     "MSTREAM_THREADS"     // Threads per process
+#define ENV_TLAYOUT     "MSTREAM_TLAYOUT"     // Thread layout (LayoutType)
+#define ENV_TRACE       "MSTREAM_TRACE"       // Binary trace (BENCHMARK_TRACE)
+#define ENV_THINK       "MSTREAM_THINK"       // Trace think-time (0 = No)
+#define ENV_SKEW        "MSTREAM_SKEW"        // Zipfian exponent
+#define ENV_HOT_ACCESS  "MSTREAM_HOT_ACCESS"  // % of accesses to hot data
+#define ENV_HOT_DATA    "MSTREAM_HOT_DATA"    // % of hot data
+#define ENV_HOT_MOVE    "MSTREAM_HOT_MOVE"    // Accesses per hotspot move
+#define ENV_URING_QD    "MSTREAM_URING_QD"    // io_uring queue depth
+#define ENV_URING_BATCH "MSTREAM_URING_BATCH" // io_uring submission batch
+#define ENV_URING_FIXED "MSTREAM_URING_FIXED" // Fixed buffers (1) / file (2)
+#define ENV_DIRECT      "MSTREAM_DIRECT"      // O_DIRECT explicit I/O (0 = No)
+#define ENV_UFFD_BUDGET "MSTREAM_UFFD_BUDGET" // Resident bytes (IMPL_UFFD)
+#define ENV_PERF        "MSTREAM_PERF"        // perf_event counters (0 = No)
+#define ENV_ISA         "MSTREAM_ISA"         // STREAM kernels (kernelisa_t)
+#define ENV_NT          "MSTREAM_NT"          // Non-temporal stores (0 = No)
+#define ENV_MAPVAR      "MSTREAM_MAPVAR"      // MEM / MMAP variant (MAPVAR_*)
+#define ENV_OOC         "MSTREAM_OOC"         // Working set / budget ratios
+#define ENV_SAMPLE      "MSTREAM_SAMPLE"      // Sampler interval (ms, 0 = No)
+#define ENV_SAMPLE_ALL  "MSTREAM_SAMPLE_ALL"  // Merge samples on rank 0
+#define ENV_FLUSH_INT   "MSTREAM_FLUSH_INT"   // ummap-io flush interval
+#define ENV_CKPT_DIRTY  "MSTREAM_CKPT_DIRTY"  // % of dirty data per checkpoint
+#define ENV_CKPT_LAYOUT "MSTREAM_CKPT_LAYOUT" // Dirty chunks (CkptLayoutType)
+#define ENV_RMA_TARGET  "MSTREAM_RMA_TARGET"  // Window targets (rmatarget_t)
+#define ENV_RMA_BATCH   "MSTREAM_RMA_BATCH"   // Window operations per flush
+#define ENV_MPIIO_MODE  "MSTREAM_MPIIO_MODE"  // Shared file mode (mpiiomode_t)
+#define ENV_MPIIO_HINTS "MSTREAM_MPIIO_HINTS" // MPI-IO hints ("key=value,...")
+#define ENV_MPIIO_DEPTH "MSTREAM_MPIIO_DEPTH" // Pending non-blocking operations
+#define ENV_SHARED      "MSTREAM_SHARED"      // Shared backing file (0 = No)
+#define ENV_SLICE_ALIGN "MSTREAM_SLICE_ALIGN" // Alignment of the shared slices
+#define ENV_SLICE_BLOCK "MSTREAM_SLICE_BLOCK" // Interleaving block (0 = No)
+#define ENV_RAND        "MSTREAM_RAND"        // Random offsets (RandType)
+#define ENV_RAND_BLOCK  "MSTREAM_RAND_BLOCK"  // Chunks per block (RAND_BLOCKED)
+#define ENV_WARMUP      "MSTREAM_WARMUP"      // Untimed warm-up passes
+#define ENV_ITER        "MSTREAM_ITER"        // Timed passes (minimum)
+#define ENV_ITER_MAX    "MSTREAM_ITER_MAX"    // Timed passes (maximum)
+#define ENV_CI          "MSTREAM_CI"          // Target 95% CI (% of the mean)
+#define ENV_OUTLIER     "MSTREAM_OUTLIER"     // Outlier z-score (0 = Keep all)
+#define ENV_JSON        "MSTREAM_JSON"        // JSON Lines record (appended)
+#define ENV_NUMA        "MSTREAM_NUMA"        // Placement (numapolicy_t)
+#define ENV_CACHE       "MSTREAM_CACHE"       // Page cache state (cachestate_t)
+#define ENV_MEM         "MSTREAM_MEM"         // Footprint sampling (0 = No)
+#define ENV_MEM_INT     "MSTREAM_MEM_INT"     // Footprint interval (ms, 0 = No)
+#define ENV_PREFETCH    "MSTREAM_PREFETCH"    // Prefetch distances (chunks)
+
 enum BenchmarkType
 {
     BENCHMARK_SEQUENTIAL = 0, // 0
     BENCHMARK_PADDING,        // 1
     BENCHMARK_PRANDOM,        // 2
-    BENCHMARK_MIXED           // 3
+    BENCHMARK_MIXED,          // 3
+    BENCHMARK_TRACE,          // 4
+    BENCHMARK_ZIPF,           // 5
+    BENCHMARK_HOTCOLD,        // 6
+    BENCHMARK_HOTSPOT,        // 7
+    BENCHMARK_STREAM,         // 8
+    BENCHMARK_CHECKPOINT      // 9
 };
 
 enum ImplType
@@ -39,7 +113,29 @@ enum ImplType
     IMPL_UMMAP,   // 2
     IMPL_MPI1SM,  // 3
     IMPL_MPI1SS,  // 4
-    IMPL_MPIIO    // 5
+    IMPL_MPIIO,   // 5
+    IMPL_URING,   // 6
+    IMPL_UFFD     // 7
+};
+
+enum LayoutType
+{
+    LAYOUT_DISJOINT = 0, // 0
+    LAYOUT_INTERLEAVED   // 1
+};
+
+enum CkptLayoutType
+{
+    CKPT_CLUSTERED = 0, // 0 << Consecutive chunks
+    CKPT_SCATTERED      // 1 << Chunks spread evenly over the allocation
+};
+
+enum RandType
+{
+    RAND_LEGACY = 0,  // 0 << rand_r() + modulo (i.e., not chunk-aligned)
+    RAND_ALIGNED,     // 1 << Uniform chunks (i.e., with repetitions)
+    RAND_PERMUTATION, // 2 << Every chunk exactly once per pass
+    RAND_BLOCKED      // 3 << Blocks of consecutive chunks, once per pass
 };
 
 enum PolicyType
@@ -52,6 +148,102 @@ enum PolicyType
     UMMAP_PTYPE_WIRO_L    // 5
 };
 
+/**
+ * Structure that contains the result of a single checkpoint cycle.
+ */
+typedef struct
+{
+    double   dirty_pct;
+    uint32_t cycle;
+    size_t   dirty_size;
+    double   latency;
+    uint32_t num_writes;
+    size_t   write_bytes;
+} ckpt_cycle_t;
+
+/**
+ * Structure that contains a snapshot of the counters of the user-space pager.
+ */
+typedef struct
+{
+    uint32_t num_reads;
+    uint32_t num_writes;
+    uint32_t num_fills;
+} pagersample_t;
+
+/**
+ * Structure that contains the settings of the repetitions and the duration
+ * of each timed pass of every thread (i.e., the passes of a thread are
+ * consecutive). After the minimum number of passes, the repetitions stop once
+ * the confidence interval of the mean pass reaches the target on every
+ * process, or once the maximum number of passes is reached.
+ */
+typedef struct
+{
+    uint32_t num_warmup;
+    uint32_t min_passes;
+    uint32_t max_passes;
+    double   ci_target;
+    double   outlier_z;
+    int      is_done;
+    uint64_t *pass_time;
+} rep_t;
+
+/**
+ * Structure that contains the settings and the results of the benchmark for
+ * each of the threads of the process.
+ */
+typedef struct
+{
+    int               impl_type;
+    int               benchmark;
+    char              *baseptr;
+    MPI_Win           win;
+    mpiio_t           *mpiio;
+    int               rank;
+    int               is_dynamic;
+    size_t            alloc_size;
+    size_t            chunk_size;
+    uint32_t          thread_id;
+    uint32_t          num_threads;
+    int               layout;
+    hist_t            *hist;
+    const trace_t     *trace;
+    int               is_think;
+    dist_t            dist;
+    uring_t           uring;
+    pthread_barrier_t *barrier;
+    const perf_t      *perf;
+    perfsample_t      perf_start;
+    int               read_file;
+    pagersample_t     pager_start;
+    kernelisa_t       isa;
+    int               is_nt;
+    uint64_t          kernel_time[KERNEL_NUM_TYPES];
+    uint64_t          kernel_min[KERNEL_NUM_TYPES];
+    progress_t        progress;
+    uffd_t            *uffd;
+    const double      *ckpt_dirty;
+    uint32_t          num_dirty;
+    int               ckpt_layout;
+    ckpt_cycle_t      *ckpt_cycles;
+    uint32_t          num_cycles;
+    rma_t             *rma;
+    rep_t             *rep;
+    uint32_t          num_passes;
+    size_t            evict_budget;
+    uint64_t          evict_bytes;
+    uint32_t          pf_distance;
+    uint64_t          pf_issued;
+    uint64_t          pf_late;
+    const numa_t      *numa;
+    int               cpu;
+    int               cpu_node;
+    timespec_t        start;
+    timespec_t        stop;
+    int               result;
+} bmark_thread_t;
+
 #ifdef MPI_SWIN_ENABLED
 /**
  * Helper method that allows to create an MPI_Info object to enable Storage
@@ -90,80 +282,550 @@ int setStorageInfo(char *filename, size_t seg_size, MPI_Info* info) __CHK_FN__
 }
 #endif
 
+/**
+ * Helper method that reads / writes a single chunk from / to the given offset,
+ * according to the implementation type.
+ */
+static inline int launchOperation(int impl_type, char *baseptr, rma_t *rma,
+                                  mpiio_t *mpiio, uring_t *uring, off_t offset,
+                                  void *baseptr_tmp, size_t chunk_size,
+                                  int is_write) __CHK_FN__
+{
+    if (is_write)
+    {
+        switch (impl_type)
+        {
+            case IMPL_MPI1SM:
+            case IMPL_MPI1SS:
+            {
+                CHK(rmaSubmit(rma, offset, baseptr_tmp, chunk_size, TRUE));
+            } break;
+            
+            case IMPL_MPIIO:
+            {
+                CHK(mpiioSubmit(mpiio, offset, baseptr_tmp, chunk_size, TRUE));
+            } break;
+            
+            case IMPL_URING:
+            {
+                CHK(uringSubmit(uring, offset, baseptr_tmp, chunk_size,
+                                TRUE));
+            } break;
+            
+            default: // IMPL_MEM + IMPL_MMAP + IMPL_UMMAP + IMPL_UFFD
+                memcpy(&baseptr[offset], baseptr_tmp, chunk_size);
+        }
+    }
+    else
+    {
+        switch (impl_type)
+        {
+            case IMPL_MPI1SM:
+            case IMPL_MPI1SS:
+            {
+                CHK(rmaSubmit(rma, offset, baseptr_tmp, chunk_size, FALSE));
+            } break;
+            
+            case IMPL_MPIIO:
+            {
+                CHK(mpiioSubmit(mpiio, offset, baseptr_tmp, chunk_size,
+                                FALSE));
+            } break;
+            
+            case IMPL_URING:
+            {
+                CHK(uringSubmit(uring, offset, baseptr_tmp, chunk_size,
+                                FALSE));
+            } break;
+            
+            default: // IMPL_MEM + IMPL_MMAP + IMPL_UMMAP + IMPL_UFFD
+                memcpy(baseptr_tmp, &baseptr[offset], chunk_size);
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
 /**
  * Sequential / Random benchmark that stores chunks of a fixed size or
  * separated by a padding. The benchmark combines read / write operations.
+ * The accesses are limited to the region that starts at the given base offset.
+ * If a distribution is provided, the chunks are selected from it instead.
+ * If provided, the latency of each operation is also recorded into the read /
+ * write histogram pair (on completion, for the asynchronous implementations).
+ * The progress of the thread is updated after each operation, and the reads
+ * of the prefetcher (if any) are issued before it. The chunks read by the
+ * prefetcher are taken from its buffers instead of reading them again.
  */
-int launchBenchmark(int impl_type, char *baseptr, MPI_Win win, MPI_File file,
-                    int is_random, int drank, size_t alloc_size, size_t size_b,
-                    size_t chunk_size, size_t padding) __CHK_FN__
+int launchBenchmark(int impl_type, char *baseptr, rma_t *rma, mpiio_t *mpiio,
+                    uring_t *uring, int is_random, dist_t *dist, uint32_t seed,
+                    off_t base, size_t region_size, size_t size_b,
+                    size_t chunk_size, off_t offset_init, size_t padding,
+                    hist_t *hist, progress_t *progress,
+                    prefetch_t *prefetch) __CHK_FN__
 {
     off_t    offset       = 0;
     int      write_active = TRUE;
-    void     *baseptr_tmp = malloc(chunk_size);
-    uint32_t seed         = (drank + 1) * 921;
+    int      is_consumed  = FALSE;
+    void     *baseptr_tmp = allocBuffer(chunk_size);
+    uint64_t op_start     = 0;
+    
+    // The latency of the asynchronous operations is recorded on completion
+    if (impl_type == IMPL_URING)
+    {
+        uring->hist = hist;
+        hist        = NULL;
+    }
     
     if (is_random)
     {
-        // Set the seed and generate the first offset
+        // Set the seed
         rand_r(&seed);
-        offset = RAND_OFFSET(seed, chunk_size, alloc_size);
     }
     
     for (off_t offset_b = 0; offset_b < size_b; offset_b += chunk_size)
     {
-        if (write_active)
+        // Draw the offset before each operation, so that no offset is drawn
+        // past the last one (e.g., the passes of a permutation stay aligned)
+        offset = base + ((is_random) ?
+                           RAND_OFFSET(seed, chunk_size, region_size) :
+                         (dist != NULL) ?
+                           (off_t)(distNext(dist) * chunk_size) :
+                         (offset_b > 0) ?
+                           ((offset - base + padding) % region_size) :
+                           offset_init);
+        
+        if (prefetch != NULL)
+        {
+            CHK(prefetchAdvance(prefetch, (offset_b / chunk_size)));
+        }
+        
+        if (hist != NULL)
         {
+            op_start = histGetTime();
+        }
+        
 #if VERIFY_OUTPUT
+        if (write_active)
+        {
             memset(baseptr_tmp, ((offset_b / chunk_size) + 1), chunk_size);
+        }
 #endif
+        
+        if (prefetch != NULL && !write_active)
+        {
+            CHK(prefetchConsume(prefetch, (offset_b / chunk_size),
+                                baseptr_tmp, &is_consumed));
+        }
+        
+        if (!is_consumed)
+        {
+            CHK(launchOperation(impl_type, baseptr, rma, mpiio, uring, offset,
+                                baseptr_tmp, chunk_size, write_active));
+        }
+        
+        is_consumed = FALSE;
+        
+        if (hist != NULL)
+        {
+            histRecord(&hist[(write_active) ? HIST_WRITE : HIST_READ],
+                       (histGetTime() - op_start));
+        }
+        
+        progressAdd(progress, chunk_size);
+        
+        write_active = !write_active;
+    }
+    
+    free(baseptr_tmp);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that launches one of the access patterns, after splitting the
+ * work among the threads of the process (i.e., each thread either accesses a
+ * disjoint region of the allocation, or every N-th chunk of the pattern).
+ * The padding patterns launch a prefetcher ahead of the thread, if requested.
+ */
+int launchPattern(bmark_thread_t *bthread, int is_random, dist_t *dist,
+                  size_t size_b, size_t padding, hist_t *hist) __CHK_FN__
+{
+    const uint32_t thread_id   = bthread->thread_id;
+    const uint32_t num_threads = bthread->num_threads;
+    const uint32_t seed        = (bthread->rank + 1) * 921 + thread_id * 7919;
+    off_t          base        = 0;
+    size_t         region_size = bthread->alloc_size;
+    off_t          offset_init = 0;
+    prefetch_t     prefetch    = { 0 };
+    int            is_prefetch = FALSE;
+    
+    // The random offsets are taken from the generator, if initialized
+    if (is_random && bthread->dist.num_items > 0)
+    {
+        is_random = FALSE;
+        dist      = &bthread->dist;
+    }
+    
+    // Each pass starts a new permutation, which the threads of the
+    // interleaved layout split by their index (e.g., half of it for MIXED)
+    if (dist != NULL && bthread->layout == LAYOUT_INTERLEAVED)
+    {
+        distRestart(dist, thread_id, num_threads);
+    }
+    else if (dist != NULL)
+    {
+        distRestart(dist, 0, 1);
+    }
+    
+    if (num_threads > 1 && bthread->layout == LAYOUT_DISJOINT)
+    {
+        region_size = (region_size / num_threads / bthread->chunk_size) *
+                      bthread->chunk_size;
+        base        = region_size * thread_id;
+    }
+    else if (num_threads > 1)
+    {
+        offset_init = padding * thread_id;
+        padding     = padding * num_threads;
+    }
+    
+    // The helper thread of the mapped implementations shares the CPUs of the
+    // node instead of the CPU of the pinned thread
+    if (bthread->pf_distance > 0 && !is_random && dist == NULL)
+    {
+        const size_t            chunk_size = bthread->chunk_size;
+        const prefetchpattern_t pattern    = {
+            base, region_size, offset_init, padding, chunk_size,
+            ((size_b / num_threads) + chunk_size - 1) / chunk_size };
+        const prefetchmode_t    mode       =
+                    (bthread->impl_type == IMPL_MMAP)  ? PREFETCH_ADVISE :
+                    (bthread->impl_type == IMPL_MPIIO) ? PREFETCH_READ :
+                                                         PREFETCH_TOUCH;
+        
+        CHK(prefetchStart(&prefetch, mode, bthread->baseptr,
+                          bthread->mpiio->file, &bthread->progress, &pattern,
+                          bthread->pf_distance,
+                          ((bthread->numa->policy != NUMA_POLICY_NONE) ?
+                           &bthread->numa->cpus : NULL)));
+        is_prefetch = TRUE;
+    }
+    
+    CHK(launchBenchmark(bthread->impl_type, bthread->baseptr, bthread->rma,
+                        bthread->mpiio, &bthread->uring, is_random, dist, seed,
+                        base, region_size, (size_b / num_threads),
+                        bthread->chunk_size, offset_init, padding, hist,
+                        &bthread->progress,
+                        ((is_prefetch) ? &prefetch : NULL)));
+    
+    if (is_prefetch)
+    {
+        CHK(prefetchStop(&prefetch));
+        bthread->pf_issued += prefetch.num_issued;
+        bthread->pf_late   += prefetch.num_late;
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Trace-replay benchmark that issues the read / write operations of a binary
+ * trace, optionally waiting for the think-time of each record. The records
+ * are split among the threads of the process following the thread layout.
+ */
+int launchTrace(bmark_thread_t *bthread, hist_t *hist) __CHK_FN__
+{
+    const trace_t  *trace       = bthread->trace;
+    const uint64_t num_records  = trace->header->num_records;
+    const size_t   alloc_size   = bthread->alloc_size;
+    void           *baseptr_tmp = allocBuffer(trace->header->max_length);
+    uint64_t       record_start = 0;
+    uint64_t       record_end   = num_records;
+    uint64_t       record_step  = 1;
+    uint64_t       op_start     = 0;
+    
+    // The latency of the asynchronous operations is recorded on completion
+    if (bthread->impl_type == IMPL_URING)
+    {
+        bthread->uring.hist = hist;
+        hist                = NULL;
+    }
+    
+    if (bthread->layout == LAYOUT_DISJOINT)
+    {
+        record_start = num_records * bthread->thread_id / bthread->num_threads;
+        record_end   = num_records * (bthread->thread_id + 1) /
+                       bthread->num_threads;
+    }
+    else
+    {
+        record_start = bthread->thread_id;
+        record_step  = bthread->num_threads;
+    }
+    
+    for (uint64_t r = record_start; r < record_end; r += record_step)
+    {
+        const trace_record_t *record = &trace->records[r];
+        size_t               length  = (record->length < alloc_size) ?
+                                       record->length : alloc_size;
+        off_t                offset  = record->offset % alloc_size;
+        
+        // Fold the operation into the allocation, if needed
+        if ((offset + length) > alloc_size)
+        {
+            offset = alloc_size - length;
+        }
+        
+        // Wait for the think-time of the record without yielding the CPU
+        if (bthread->is_think && record->think_us > 0)
+        {
+            const uint64_t think_end = histGetTime() + record->think_us * 1000;
+            while (histGetTime() < think_end);
+        }
+        
+        if (hist != NULL)
+        {
+            op_start = histGetTime();
+        }
+        
+        CHK(launchOperation(bthread->impl_type, bthread->baseptr, bthread->rma,
+                            bthread->mpiio, &bthread->uring, offset,
+                            baseptr_tmp, length, record->is_write));
+        
+        if (hist != NULL)
+        {
+            histRecord(&hist[(record->is_write) ? HIST_WRITE : HIST_READ],
+                       (histGetTime() - op_start));
+        }
+        
+        progressAdd(&bthread->progress, length);
+    }
+    
+    free(baseptr_tmp);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * STREAM benchmark that launches the copy, scale, add and triad kernels over
+ * three arrays placed consecutively inside the allocation. Each thread works
+ * on a disjoint slice of the arrays, and the threads synchronize after each
+ * kernel so that the first thread can time it. If requested, the arrays are
+ * only initialized instead (i.e., first-touch of the slice).
+ */
+int launchStream(bmark_thread_t *bthread, int is_init) __CHK_FN__
+{
+    // Destination and sources of each kernel (a = 0, b = 1, c = 2)
+    static const int kernel_args[KERNEL_NUM_TYPES][3] = {
+        { 2, 0, 0 }, // KERNEL_COPY
+        { 1, 2, 2 }, // KERNEL_SCALE
+        { 2, 0, 1 }, // KERNEL_ADD
+        { 0, 1, 2 }  // KERNEL_TRIAD
+    };
+    const size_t num_elems   = STREAM_ELEMS(bthread->alloc_size);
+    const size_t slice_elems = ((num_elems / bthread->num_threads) >> 3) << 3;
+    const size_t slice_start = slice_elems * bthread->thread_id;
+    const size_t slice_size  = (bthread->thread_id ==
+                                (bthread->num_threads - 1)) ?
+                               (num_elems - slice_start) : slice_elems;
+    double       *arrays[3]  = { NULL };
+    
+    for (int array = 0; array < 3; array++)
+    {
+        arrays[array] = (double *)bthread->baseptr + (num_elems * array) +
+                        slice_start;
+    }
+    
+    if (is_init)
+    {
+        for (size_t i = 0; i < slice_size; i++)
+        {
+            arrays[0][i] = 1.0;
+            arrays[1][i] = 2.0;
+            arrays[2][i] = 0.0;
+        }
+    }
+    
+    for (int type = 0; type < KERNEL_NUM_TYPES && !is_init; type++)
+    {
+        const kernelfn_t kernel = kernelGet(type, bthread->isa, bthread->is_nt);
+        uint64_t         start  = 0;
+        
+        pthread_barrier_wait(bthread->barrier);
+        start = histGetTime();
+        
+        kernel(arrays[kernel_args[type][0]], arrays[kernel_args[type][1]],
+               arrays[kernel_args[type][2]], KERNEL_SCALAR, slice_size);
+        progressAdd(&bthread->progress, kernelGetBytes(type) * slice_size);
+        
+        pthread_barrier_wait(bthread->barrier);
+        
+        if (bthread->thread_id == 0)
+        {
+            const uint64_t elapsed     = histGetTime() - start;
+            uint64_t       *kernel_min = &bthread->kernel_min[type];
             
-            switch (impl_type)
-            {
-                case IMPL_MPI1SM:
-                case IMPL_MPI1SS:
-                {
-                    CHK(MPI_Put(baseptr_tmp, chunk_size, MPI_BYTE, drank,
-                                offset, chunk_size, MPI_BYTE, win));
-                    CHK(MPI_Win_flush_local(drank, win));
-                } break;
-                
-                case IMPL_MPIIO:
-                {
-                    CHK(MPI_File_write_at(file, offset, baseptr_tmp, chunk_size,
-                                          MPI_BYTE, MPI_STATUS_IGNORE));
-                } break;
-                
-                default: // IMPL_MEM + IMPL_MMAP + IMPL_UMMAP
-                    memcpy(&baseptr[offset], baseptr_tmp, chunk_size);
-            }
+            bthread->kernel_time[type] += elapsed;
+            *kernel_min = (*kernel_min == 0 || elapsed < *kernel_min) ?
+                          elapsed : *kernel_min;
         }
-        else
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that synchronizes the resources, according to the
+ * implementation type.
+ */
+int syncResources(bmark_thread_t *bthread, uffd_t *uffd) __CHK_FN__
+{
+    switch (bthread->impl_type)
+    {
+        case IMPL_MPI1SM:
+        case IMPL_MPI1SS:
+        {
+            CHK(rmaSync(bthread->rma));
+        } break;
+        
+        case IMPL_MPIIO:
+        {
+            CHK(mpiioSync(bthread->mpiio));
+        } break;
+        
+        case IMPL_URING:
         {
-            switch (impl_type)
+            CHK(uringSync(&bthread->uring));
+        } break;
+        
+        case IMPL_UFFD:
+        {
+            CHK(uffdSync(uffd));
+        } break;
+        
+        case IMPL_UMMAP:
+        {
+            CHK(umsync(bthread->baseptr, FALSE));
+        } break;
+        
+        default: // IMPL_MEM + IMPL_MMAP
+        {
+            CHK(msync(bthread->baseptr, bthread->alloc_size, MS_SYNC));
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that retrieves the number of segments read / written by the
+ * user-space pager (i.e., ummap-io or the userfaultfd pager).
+ */
+int getPagerStats(int impl_type, uffd_t *uffd, uint32_t *num_reads,
+                  uint32_t *num_writes) __CHK_FN__
+{
+    if (impl_type == IMPL_UFFD)
+    {
+        uffdStats(uffd, num_reads, num_writes);
+    }
+    else
+    {
+        CHK(umstats(num_reads, num_writes));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that takes a snapshot of the counters of the user-space
+ * pager. ummap-io only reports the segments read, so that the segments
+ * filled are only known when every fill reads the file (i.e., read_file).
+ */
+int getPagerSample(int impl_type, uffd_t *uffd, int read_file,
+                   pagersample_t *sample) __CHK_FN__
+{
+    CHK(getPagerStats(impl_type, uffd, &sample->num_reads,
+                      &sample->num_writes));
+    
+    sample->num_fills = (impl_type == IMPL_UFFD) ? uffdFills(uffd) :
+                        (read_file) ? sample->num_reads : 0;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Checkpoint benchmark that dirties a fraction of the allocation and then
+ * synchronizes the resources, for each of the requested fractions. The dirty
+ * chunks are either clustered (i.e., consecutive) or scattered evenly over
+ * the allocation, and the first chunk rotates on every cycle. The latency of
+ * the synchronization and the data written are recorded per cycle.
+ */
+int launchCheckpoint(bmark_thread_t *bthread, hist_t *hist) __CHK_FN__
+{
+    const size_t   chunk_size  = bthread->chunk_size;
+    const uint64_t num_chunks  = bthread->alloc_size / chunk_size;
+    const uint32_t cycle       = bthread->num_cycles / bthread->num_dirty;
+    void           *baseptr_tmp = allocBuffer(chunk_size);
+    uint64_t       op_start     = 0;
+    
+    memset(baseptr_tmp, (cycle + 1), chunk_size);
+    
+    for (uint32_t i = 0; i < bthread->num_dirty; i++)
+    {
+        ckpt_cycle_t   *ckpt       = &bthread->ckpt_cycles[
+                                                    bthread->num_cycles++];
+        const uint64_t num_dirty   = (uint64_t)(num_chunks *
+                                                bthread->ckpt_dirty[i] / 100.0);
+        const int      is_spread   = (bthread->ckpt_layout ==
+                                      CKPT_SCATTERED);
+        const uint64_t first       = ((uint64_t)cycle * 7919) % num_chunks;
+        uint32_t       num_reads   = 0;
+        uint32_t       num_writes  = 0;
+        size_t         write_bytes = getWriteBytes();
+        timespec_t     start;
+        timespec_t     stop;
+        
+        for (uint64_t chunk = 0; chunk < num_dirty; chunk++)
+        {
+            const uint64_t index  = (is_spread) ?
+                                    ((chunk * num_chunks) / num_dirty) : chunk;
+            const off_t    offset = ((first + index) % num_chunks) *
+                                    chunk_size;
+            
+            if (hist != NULL)
             {
-                case IMPL_MPI1SM:
-                case IMPL_MPI1SS:
-                {
-                    CHK(MPI_Get(baseptr_tmp, chunk_size, MPI_BYTE, drank,
-                                offset, chunk_size, MPI_BYTE, win));
-                    CHK(MPI_Win_flush_local(drank, win));
-                } break;
-                
-                case IMPL_MPIIO:
-                {
-                    CHK(MPI_File_read_at(file, offset, baseptr_tmp, chunk_size,
-                                         MPI_BYTE, MPI_STATUS_IGNORE));
-                } break;
-                
-                default: // IMPL_MEM + IMPL_MMAP + IMPL_UMMAP
-                    memcpy(baseptr_tmp, &baseptr[offset], chunk_size);
+                op_start = histGetTime();
+            }
+            
+            CHK(launchOperation(bthread->impl_type, bthread->baseptr,
+                                bthread->rma, bthread->mpiio, &bthread->uring,
+                                offset, baseptr_tmp, chunk_size, TRUE));
+            
+            if (hist != NULL)
+            {
+                histRecord(&hist[HIST_WRITE], (histGetTime() - op_start));
             }
+            
+            progressAdd(&bthread->progress, chunk_size);
         }
         
-        offset       = (is_random) ? RAND_OFFSET(seed, chunk_size, alloc_size) :
-                                     (offset + padding) % alloc_size;
-        write_active = !write_active;
+        CHK(getPagerStats(bthread->impl_type, bthread->uffd, &num_reads,
+                          &num_writes));
+        ckpt->num_writes = num_writes;
+        
+        clock_gettime(CLOCK_REALTIME, &start);
+        CHK(syncResources(bthread, bthread->uffd));
+        clock_gettime(CLOCK_REALTIME, &stop);
+        
+        CHK(getPagerStats(bthread->impl_type, bthread->uffd, &num_reads,
+                          &num_writes));
+        
+        ckpt->dirty_pct   = bthread->ckpt_dirty[i];
+        ckpt->cycle       = cycle;
+        ckpt->dirty_size  = num_dirty * chunk_size;
+        ckpt->latency     = getElapsed(start, stop, TSUNIT_MSEC);
+        ckpt->num_writes  = num_writes - ckpt->num_writes;
+        ckpt->write_bytes = getWriteBytes() - write_bytes;
     }
     
     free(baseptr_tmp);
@@ -171,17 +833,549 @@ int launchBenchmark(int impl_type, char *baseptr, MPI_Win win, MPI_File file,
     return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
 }
 
-int main (int argc, char *argv[]) __CHK_FN__
+/**
+ * Helper method that summarizes the timed passes of the process, in seconds.
+ * The threads run each pass concurrently, so that the duration of a pass is
+ * given by the slowest thread.
+ */
+void getPassStats(const bmark_thread_t *bthread, stats_t *stats)
 {
-    // Input parameters for the benchmark
-    size_t     alloc_size         = 0;
-    size_t     seg_size           = 0;
+    const rep_t    *rep        = bthread->rep;
+    const uint32_t num_passes  = bthread->num_passes;
+    double         *pass_time  = (double *)calloc(num_passes + 1,
+                                                  sizeof(double));
+    
+    for (uint32_t pass = 0; pass < num_passes; pass++)
+    {
+        for (uint32_t thread_id = 0; thread_id < bthread->num_threads;
+             thread_id++)
+        {
+            const double value = rep->pass_time[thread_id * rep->max_passes +
+                                                pass] / 1000000000.0;
+            
+            pass_time[pass] = (value > pass_time[pass]) ? value :
+                                                          pass_time[pass];
+        }
+    }
+    
+    statsCompute(pass_time, num_passes, rep->outlier_z, stats);
+    free(pass_time);
+}
+
+/**
+ * Helper method that decides whether the repetitions can stop, once the
+ * relative confidence interval of every process reaches the target. The
+ * first thread takes the decision, while the rest of threads wait for it.
+ */
+int checkRepetitions(bmark_thread_t *bthread) __CHK_FN__
+{
+    rep_t *rep = bthread->rep;
+    
+    pthread_barrier_wait(bthread->barrier);
+    
+    if (bthread->thread_id == 0)
+    {
+        stats_t stats   = { 0 };
+        int     is_done = FALSE;
+        
+        getPassStats(bthread, &stats);
+        is_done = (stats.mean > 0.0 &&
+                   ((stats.ci / stats.mean) * 100.0) <= rep->ci_target);
+        
+        CHK(MPI_Allreduce(&is_done, &rep->is_done, 1, MPI_INT, MPI_LAND,
+                          MPI_COMM_WORLD));
+    }
+    
+    pthread_barrier_wait(bthread->barrier);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that evicts the segments of ummap-io once the threads have
+ * accessed the budget since the last eviction (i.e., ummap-io has no resident
+ * limit of its own). The first thread evicts between the passes, while the
+ * rest of threads wait for it, so that the mapping is not accessed meanwhile.
+ */
+int evictPass(bmark_thread_t *bthread) __CHK_FN__
+{
+    pthread_barrier_wait(bthread->barrier);
+    
+    if (bthread->thread_id == 0)
+    {
+        uint64_t num_bytes = 0;
+        
+        for (uint32_t thread_id = 0; thread_id < bthread->num_threads;
+             thread_id++)
+        {
+            num_bytes += bthread[thread_id].progress.num_bytes;
+        }
+        
+        if ((num_bytes - bthread->evict_bytes) >= bthread->evict_budget)
+        {
+            CHK(umsync(bthread->baseptr, TRUE));
+            bthread->evict_bytes = num_bytes;
+        }
+    }
+    
+    pthread_barrier_wait(bthread->barrier);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that launches all the iterations of the benchmark. The timer
+ * of each thread starts after the warm-up iterations of every thread of the
+ * process have completed, and each of the timed passes is also timed apart.
+ */
+int launchIterations(bmark_thread_t *bthread) __CHK_FN__
+{
+    const size_t   alloc_size = bthread->alloc_size;
+    const size_t   chunk_size = bthread->chunk_size;
+    rep_t          *rep       = bthread->rep;
+    const uint32_t num_total  = rep->num_warmup + rep->max_passes;
+    hist_t         *hist_iter = NULL;
+    uint64_t       pass_start = 0;
+    
+    // Only the checkpoint cycles of the last run are kept (e.g., OOC)
+    bthread->num_cycles = 0;
+    bthread->num_passes = 0;
+    
+    // Pin the thread and set its memory policy (e.g., staging buffers)
+    CHK(numaSetThread(bthread->numa, bthread->thread_id));
+    
+    // The STREAM arrays are initialized before the timed iterations
+    if (bthread->benchmark == BENCHMARK_STREAM)
+    {
+        CHK(launchStream(bthread, TRUE));
+    }
+    
+    for (uint32_t iteration = 0; iteration < num_total && !rep->is_done;
+         iteration++)
+    {
+        // Start the timer after the warm-up iterations
+        if (iteration == rep->num_warmup)
+        {
+            pthread_barrier_wait(bthread->barrier);
+            
+            // The counters are shared, so only the first thread reads them
+            if (bthread->perf != NULL && bthread->thread_id == 0)
+            {
+                perfRead(bthread->perf, &bthread->perf_start);
+            }
+            
+            // The pager is also shared (i.e., the I/O of the timed passes)
+            if ((bthread->impl_type == IMPL_UMMAP ||
+                 bthread->impl_type == IMPL_UFFD) && bthread->thread_id == 0)
+            {
+                CHK(getPagerSample(bthread->impl_type, bthread->uffd,
+                                   bthread->read_file, &bthread->pager_start));
+            }
+            
+            // Discard the STREAM kernels of the warm-up iterations
+            if (bthread->thread_id == 0)
+            {
+                memset(bthread->kernel_time, 0, sizeof(bthread->kernel_time));
+                memset(bthread->kernel_min,  0, sizeof(bthread->kernel_min));
+            }
+            
+            clock_gettime(CLOCK_REALTIME, &bthread->start);
+            
+            // Record the latency histograms only for the timed iterations
+            hist_iter = bthread->hist;
+            
+            if (bthread->is_dynamic && bthread->thread_id == 0)
+            {
+                usleep(bthread->rank * 921921);
+            }
+        }
+        
+        pass_start = histGetTime();
+        
+        switch (bthread->benchmark)
+        {
+            case BENCHMARK_SEQUENTIAL:
+                CHK(launchPattern(bthread, FALSE, NULL, alloc_size, chunk_size,
+                                  hist_iter)); break;
+            case BENCHMARK_PADDING:
+                CHK(launchPattern(bthread, FALSE, NULL, alloc_size,
+                                  (chunk_size << 1), hist_iter)); break;
+            case BENCHMARK_PRANDOM:
+                CHK(launchPattern(bthread, TRUE, NULL, alloc_size, 0,
+                                  hist_iter)); break;
+            case BENCHMARK_MIXED:
+                CHK(launchPattern(bthread, TRUE, NULL, (alloc_size >> 1), 0,
+                                  hist_iter));
+                CHK(launchPattern(bthread, FALSE, NULL, (alloc_size >> 1),
+                                  (chunk_size << 1), hist_iter)); break;
+            case BENCHMARK_ZIPF:
+            case BENCHMARK_HOTCOLD:
+            case BENCHMARK_HOTSPOT:
+                CHK(launchPattern(bthread, FALSE, &bthread->dist, alloc_size,
+                                  0, hist_iter)); break;
+            case BENCHMARK_TRACE:
+                CHK(launchTrace(bthread, hist_iter)); break;
+            case BENCHMARK_STREAM:
+                CHK(launchStream(bthread, FALSE)); break;
+            case BENCHMARK_CHECKPOINT:
+                CHK(launchCheckpoint(bthread, hist_iter));
+        }
+        
+        // Record the pass and check the confidence interval, if requested
+        if (iteration >= rep->num_warmup)
+        {
+            rep->pass_time[bthread->thread_id * rep->max_passes +
+                           bthread->num_passes++] = histGetTime() - pass_start;
+            
+            if (rep->ci_target > 0.0 &&
+                bthread->num_passes >= rep->min_passes)
+            {
+                CHK(checkRepetitions(bthread));
+            }
+        }
+        
+        // Keep the resident size of ummap-io within the budget, if requested
+        if (bthread->evict_budget > 0)
+        {
+            CHK(evictPass(bthread));
+        }
+    }
+    
+    // Wait for the in-flight operations before stopping the timer
+    if (bthread->impl_type == IMPL_URING)
+    {
+        CHK(uringDrain(&bthread->uring));
+    }
+    else if (bthread->impl_type == IMPL_MPI1SM ||
+             bthread->impl_type == IMPL_MPI1SS)
+    {
+        CHK(rmaDrain(bthread->rma));
+    }
+    else if (bthread->impl_type == IMPL_MPIIO)
+    {
+        CHK(mpiioDrain(bthread->mpiio));
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &bthread->stop);
+    numaGetCPU(&bthread->cpu, &bthread->cpu_node);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that launches the benchmark on the secondary threads.
+ */
+void *launchThread(void *arg)
+{
+    bmark_thread_t *bthread = (bmark_thread_t *)arg;
+    
+    bthread->result = launchIterations(bthread);
+    
+    return NULL;
+}
+
+/**
+ * Helper method that launches the iterations on every thread of the process
+ * (i.e., the calling thread acts as the first thread) and waits for them.
+ */
+int launchThreads(bmark_thread_t *bthread, pthread_t *threads) __CHK_FN__
+{
+    const uint32_t num_threads = bthread[0].num_threads;
+    
+    bthread[0].rep->is_done = FALSE;
+    
+    for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+    {
+        CHK(pthread_create(&threads[thread_id], NULL, launchThread,
+                           &bthread[thread_id]));
+    }
+    
+    CHK(launchIterations(&bthread[0]));
+    
+    for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+    {
+        CHK(pthread_join(threads[thread_id], NULL));
+        CHK(bthread[thread_id].result);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Out-of-core benchmark that sweeps the ratio of working set (i.e., the
+ * allocation) to resident budget. The budget is applied through the pager
+ * for IMPL_UFFD, by evicting the segments of ummap-io between the passes
+ * for IMPL_UMMAP (i.e., the budget bounds the bytes accessed in between), and
+ * otherwise through a locked ballast that leaves only the budget of each
+ * process available in the node (i.e., from the memory available before the
+ * allocation). The ratios above one are skipped for IMPL_MEM, as the ballast
+ * can only force the allocation into swap. Each ratio launches all the
+ * iterations and the synchronization, without recording histograms. The
+ * sweep runs after the regular benchmark (i.e., it leaves the mapping warm).
+ */
+int launchOutOfCore(bmark_thread_t *bthread, pthread_t *threads, uffd_t *uffd,
+                    size_t iter_size, size_t mem_avail,
+                    const char *ratios) __CHK_FN__
+{
+    const int      rank        = bthread[0].rank;
+    const int      impl_type   = bthread[0].impl_type;
+    const size_t   alloc_size  = bthread[0].alloc_size;
+    const uint32_t num_threads = bthread[0].num_threads;
+    char           *ratio_str  = strdup(ratios);
+    char           *saveptr    = NULL;
+    MPI_Comm       comm_node   = MPI_COMM_NULL;
+    int            num_local   = 0;
+    int            num_procs   = 0;
+    
+    // The histograms of the regular benchmark are already released
+    for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+    {
+        bthread[thread_id].hist = NULL;
+    }
+    
+    // Split the available memory of the node among its processes
+    CHK(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
+    CHK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                            MPI_INFO_NULL, &comm_node));
+    CHK(MPI_Comm_size(comm_node, &num_local));
+    mem_avail /= num_local;
+    
+    for (char *token = strtok_r(ratio_str, ",", &saveptr); token != NULL;
+         token = strtok_r(NULL, ",", &saveptr))
+    {
+        const double  ratio         = atof(token);
+        const size_t  budget        = (size_t)(alloc_size / ratio);
+        size_t        ballast_size  = 0;
+        void          *ballast      = NULL;
+        int           is_locked     = FALSE;
+        uint32_t      num_reads[2]  = { 0 };
+        uint32_t      num_writes[2] = { 0 };
+        struct rusage usage[2];
+        timespec_t    start;
+        timespec_t    stop;
+        
+        CHKB((ratio <= 0.0), EINVAL);
+        
+        if (impl_type == IMPL_MEM && budget < alloc_size)
+        {
+            if (rank == 0)
+            {
+                fprintf(stderr, "Warning: The ratio %lf is skipped, as the "
+                                "allocation cannot be paged out!\n", ratio);
+            }
+            
+            continue;
+        }
+        else if (impl_type == IMPL_UFFD)
+        {
+            CHK(uffdSetBudget(uffd, budget));
+        }
+        else if (impl_type == IMPL_UMMAP)
+        {
+            // The bytes accessed so far (e.g., previous ratios) are skipped
+            bthread[0].evict_bytes = 0;
+            
+            for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+            {
+                bthread[thread_id].evict_budget = (budget < alloc_size) ?
+                                                  budget : 0;
+                bthread[0].evict_bytes += bthread[thread_id].progress.num_bytes;
+            }
+        }
+        else if (mem_avail > budget)
+        {
+            ballast_size = mem_avail - budget;
+            CHK(allocBallast(ballast_size, &ballast, &is_locked));
+        }
+        
+        CHK(getPagerStats(impl_type, uffd, &num_reads[0], &num_writes[0]));
+        CHK(MPI_Barrier(MPI_COMM_WORLD));
+        
+        getrusage(RUSAGE_SELF, &usage[0]);
+        clock_gettime(CLOCK_REALTIME, &start);
+        
+        CHK(launchThreads(bthread, threads));
+        
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+        {
+            bthread[thread_id].evict_budget = 0;
+        }
+        
+        CHK(syncResources(&bthread[0], uffd));
+        
+        clock_gettime(CLOCK_REALTIME, &stop);
+        getrusage(RUSAGE_SELF, &usage[1]);
+        
+        CHK(getPagerStats(impl_type, uffd, &num_reads[1], &num_writes[1]));
+        CHK(MPI_Barrier(MPI_COMM_WORLD));
+        
+        if (ballast != NULL)
+        {
+            CHK(freeBallast(ballast, ballast_size));
+        }
+        
+        // Print the result of the ratio (in order)
+        for (int drank = 0; drank < num_procs; drank++)
+        {
+            CHK(MPI_Barrier(MPI_COMM_WORLD));
+            
+            if (drank == rank)
+            {
+                double elapsed = getElapsed(start, stop, TSUNIT_SEC);
+                
+                printf("ooc;%d;%lf;%zu;%zu;%d; %lf;%lf; %u;%u;%ld\n", rank,
+                       ratio, budget, ballast_size, is_locked, elapsed,
+                       ((iter_size * bthread[0].num_passes) / elapsed) /
+                       1048576.0,
+                       (num_reads[1]  - num_reads[0]),
+                       (num_writes[1] - num_writes[0]),
+                       (usage[1].ru_majflt - usage[0].ru_majflt));
+            }
+        }
+    }
+    
+    CHK(MPI_Comm_free(&comm_node));
+    free(ratio_str);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that sets the page cache state of the region of the process
+ * in the file. If requested, the pages that the process keeps resident are
+ * released first (i.e., the page cache does not drop the mapped pages).
+ */
+int applyCacheState(int impl_type, char *baseptr, size_t alloc_size,
+                    const char *filename, off_t offset, size_t size,
+                    int cache_state, int is_evict) __CHK_FN__
+{
+    int fd_tmp = -1;
+    
+    if (cache_state != CACHE_DEFAULT)
+    {
+        if (is_evict && impl_type == IMPL_MMAP)
+        {
+            CHKB((madvise(baseptr, alloc_size, MADV_DONTNEED) < 0), errno);
+        }
+        else if (is_evict && impl_type == IMPL_UMMAP)
+        {
+            CHK(umsync(baseptr, TRUE));
+        }
+        
+        CHK(openFile(filename, O_RDWR, FALSE, 0, &fd_tmp));
+        CHK(setCacheState(fd_tmp, offset, size, cache_state));
+        CHK(close(fd_tmp));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Prefetch benchmark that sweeps the distance of the prefetcher (i.e., the
+ * chunks requested ahead of each thread). The page cache state is set again
+ * before each distance, and each distance launches all the iterations and
+ * the synchronization, without recording histograms. The gain is relative
+ * to the bandwidth of the first distance (e.g., "0,4,16,64"). The sweep runs
+ * after the regular benchmark and the out-of-core sweep, if requested.
+ */
+int launchPrefetchSweep(bmark_thread_t *bthread, pthread_t *threads,
+                        uffd_t *uffd, size_t iter_size, const char *distances,
+                        const char *filename, off_t cache_offset,
+                        size_t cache_size, int cache_state) __CHK_FN__
+{
+    const int      rank          = bthread[0].rank;
+    const int      impl_type     = bthread[0].impl_type;
+    const uint32_t num_threads   = bthread[0].num_threads;
+    char           *distance_str = strdup(distances);
+    char           *saveptr      = NULL;
+    int            num_procs     = 0;
+    double         bandwidth_ref = 0.0;
+    
+    // The histograms of the regular benchmark are already released
+    for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+    {
+        bthread[thread_id].hist = NULL;
+    }
+    
+    CHK(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
+    
+    for (char *token = strtok_r(distance_str, ",", &saveptr); token != NULL;
+         token = strtok_r(NULL, ",", &saveptr))
+    {
+        const uint32_t distance   = atoi(token);
+        uint64_t       num_issued = 0;
+        uint64_t       num_late   = 0;
+        timespec_t     start;
+        timespec_t     stop;
+        
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+        {
+            bthread[thread_id].pf_distance = distance;
+            bthread[thread_id].pf_issued   = 0;
+            bthread[thread_id].pf_late     = 0;
+        }
+        
+        CHK(applyCacheState(impl_type, bthread[0].baseptr,
+                            bthread[0].alloc_size, filename, cache_offset,
+                            cache_size, cache_state, TRUE));
+        CHK(MPI_Barrier(MPI_COMM_WORLD));
+        
+        clock_gettime(CLOCK_REALTIME, &start);
+        
+        CHK(launchThreads(bthread, threads));
+        CHK(syncResources(&bthread[0], uffd));
+        
+        clock_gettime(CLOCK_REALTIME, &stop);
+        
+        CHK(MPI_Barrier(MPI_COMM_WORLD));
+        
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+        {
+            num_issued += bthread[thread_id].pf_issued;
+            num_late   += bthread[thread_id].pf_late;
+        }
+        
+        // Print the result of the distance (in order)
+        for (int drank = 0; drank < num_procs; drank++)
+        {
+            CHK(MPI_Barrier(MPI_COMM_WORLD));
+            
+            if (drank == rank)
+            {
+                // The warm-up passes are also covered (e.g., cold cache)
+                double elapsed   = getElapsed(start, stop, TSUNIT_SEC);
+                double bandwidth = ((iter_size * (bthread[0].rep->num_warmup +
+                                                  bthread[0].num_passes)) /
+                                    elapsed) / 1048576.0;
+                
+                bandwidth_ref = (bandwidth_ref > 0.0) ? bandwidth_ref :
+                                                        bandwidth;
+                
+                printf("prefetch;%d;%u; %lf;%lf;%lf; %lu;%lu\n", rank,
+                       distance, elapsed, bandwidth,
+                       (bandwidth / bandwidth_ref), num_issued, num_late);
+            }
+        }
+    }
+    
+    free(distance_str);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int main (int argc, char *argv[]) __CHK_FN__
+{
+    // Input parameters for the benchmark
+    size_t     alloc_size         = 0;
+    size_t     seg_size           = 0;
     size_t     chunk_size         = 0;
     int        benchmark          = BENCHMARK_SEQUENTIAL;
     int        impl_type          = IMPL_MEM;
     int        read_file          = FALSE;
     int        ptype              = UMMAP_PTYPE_FIFO;
     int        is_dynamic         = FALSE;
+    uint32_t   num_threads        = 1;
+    int        layout             = LAYOUT_DISJOINT;
     
     // Auxiliary variables required for each test
     int        rank               = 0;
@@ -190,34 +1384,324 @@ int main (int argc, char *argv[]) __CHK_FN__
     MPI_Info   info               = MPI_INFO_NULL;
     char       *baseptr           = NULL;
     int        fd                 = -1;
-    MPI_File   file               = MPI_FILE_NULL;
+    mpiio_t    mpiio              = { 0 };
     char       filename[PATH_MAX] = { 0 };
     char       tmp_path[PATH_MAX] = { 0 };
     timespec_t start[3]           = { 0 };
     timespec_t stop[3]            = { 0 };
+    hist_t     *hist              = NULL;
+    bmark_thread_t    *bthread    = NULL;
+    pthread_t         *threads    = NULL;
+    pthread_barrier_t barrier;
+    trace_t           trace       = { 0 };
+    uffd_t            *uffd       = NULL;
+    size_t            iter_size   = 0;
+    dist_t            dist        = { 0 };
+    kernelisa_t       isa         = KERNEL_ISA_AUTO;
+    int               map_variant = 0;
+    uint32_t          flush_int   = UINT_MAX;
+    uint32_t          sample_int  = 0;
+    sampler_t         sampler     = { 0 };
+    const progress_t  **progress  = NULL;
+    double            *ckpt_dirty = NULL;
+    uint32_t          num_dirty   = 0;
+    int               ckpt_layout = CKPT_CLUSTERED;
+    rma_t             rma         = { 0 };
+    int               rma_target  = RMA_TARGET_SELF;
+    int               mpiio_mode  = MPIIO_PRIVATE;
+    int               is_shared   = FALSE;
+    uint64_t          slice_align = sysconf(_SC_PAGESIZE);
+    uint64_t          slice_block = 0;
+    uint64_t          file_offset = 0;
+    uint64_t          file_size   = 0;
+    int               rand_type   = RAND_LEGACY;
+    int               level_req   = MPI_THREAD_FUNNELED;
+    int               level_avail = MPI_THREAD_SINGLE;
+    rep_t             rep         = { 0 };
+    stats_t           pass_stats  = { 0 };
+    stats_t           rep_stats[4];
+    double            rep_value[4];
+    record_t          record      = { 0 };
+    numa_t            numa;
+    numaplace_t       numa_place  = { 0 };
+    int               is_numa     = FALSE;
+    int               cache_state = CACHE_DEFAULT;
+    int               is_direct   = FALSE;
+    memstat_t         memstat     = { 0 };
+    memsample_t       mem_total[2];
+    int               is_mem      = FALSE;
+    off_t             cache_off   = 0;
+    size_t            cache_size  = 0;
+    size_t            mem_avail   = 0;
+    int               local_rank  = 0;
+    MPI_Comm          comm_node   = MPI_COMM_NULL;
+    perf_t            perf        = { 0 };
+    perfsample_t      perf_sample[4];
+    pagersample_t     pager_sample[2] = { { 0 } };
+    int               is_perf     = FALSE;
+    const char        *perf_phase[3] = { "access", "sync", "total" };
+    const char        *rep_metric[4] = { "pass", "bandwidth", "elapsed",
+                                         "sync" };
+    
+    // Check if the number of parameters match the expected
+    if (argc < 9 || argc > 10)
+    {
+        fprintf(stderr, "Error: The number of parameters is incorrect!\n");
+        fprintf(stderr, "Use: %s %s\n", argv[0], MSTREAM_PARAMS);
+        return -1;
+    }
+    
+    // Only the first thread calls MPI while the rest of threads are active
+    // (e.g., the repetitions), except the prefetcher of MPI-IO, which issues
+    // its reads from a helper thread
+    level_req = (getenv(ENV_PREFETCH) != NULL &&
+                 atoi(argv[5]) == IMPL_MPIIO) ? MPI_THREAD_MULTIPLE :
+                                                MPI_THREAD_FUNNELED;
+    
+    // Initialize MPI and retrieve the rank of the process
+    CHKPRINT(MPI_Init_thread(&argc, &argv, level_req, &level_avail));
+    CHKPRINT(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    CHKPRINT(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
+    
+    if (level_avail < level_req)
+    {
+        fprintf(stderr, "Error: The MPI library does not provide the "
+                        "required thread support (i.e., %d < %d)!\n",
+                level_avail, level_req);
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // Retrieve the benchmark settings
+    sscanf(argv[1], "%zu", &alloc_size);
+    sscanf(argv[2], "%zu", &seg_size);
+    sscanf(argv[3], "%zu", &chunk_size);
+    sscanf(argv[4], "%d",  &benchmark);
+    sscanf(argv[5], "%d",  &impl_type);
+    sscanf(argv[6], "%d",  &read_file);
+    sscanf(argv[7], "%d",  &ptype);
+    sscanf(argv[8], "%d",  &is_dynamic);
+    
+    num_threads = getEnvSize(ENV_THREADS, 1);
+    layout      = getEnvSize(ENV_TLAYOUT, LAYOUT_DISJOINT);
+    flush_int   = getEnvSize(ENV_FLUSH_INT, UINT_MAX);
+    sample_int  = getEnvSize(ENV_SAMPLE, 0);
+    rand_type   = getEnvSize(ENV_RAND, RAND_LEGACY);
+    
+    // Without a target interval, the number of timed passes is fixed
+    rep.num_warmup = getEnvSize(ENV_WARMUP, NUM_ITER_INIT);
+    rep.min_passes = getEnvSize(ENV_ITER, NUM_ITER);
+    rep.ci_target  = getEnvDouble(ENV_CI, 0.0);
+    rep.outlier_z  = getEnvDouble(ENV_OUTLIER, OUTLIER_Z);
+    rep.max_passes = getEnvSize(ENV_ITER_MAX, ((rep.ci_target > 0.0) ?
+                                               (rep.min_passes * 10) :
+                                               rep.min_passes));
+    
+    // The remote targets only apply to the window-based implementations
+    if (impl_type == IMPL_MPI1SM || impl_type == IMPL_MPI1SS)
+    {
+        rma_target = getEnvSize(ENV_RMA_TARGET, RMA_TARGET_SELF);
+    }
+    
+    // The shared file modes only apply to MPI-IO
+    if (impl_type == IMPL_MPIIO)
+    {
+        mpiio_mode = getEnvSize(ENV_MPIIO_MODE, MPIIO_PRIVATE);
+    }
+    
+    // The cache state only applies to the file-backed implementations, and
+    // O_DIRECT to the explicit I/O (i.e., the mappings use the page cache)
+    if (impl_type == IMPL_MMAP || impl_type == IMPL_UMMAP ||
+        impl_type == IMPL_MPIIO || impl_type == IMPL_URING ||
+        impl_type == IMPL_UFFD)
+    {
+        cache_state = getEnvSize(ENV_CACHE, CACHE_DEFAULT);
+    }
+    
+    if (impl_type == IMPL_MPIIO || impl_type == IMPL_URING)
+    {
+        is_direct = getEnvSize(ENV_DIRECT, FALSE);
+    }
+    
+    // The shared backing file only applies to the mapped implementations
+    if (impl_type == IMPL_MMAP || impl_type == IMPL_UMMAP ||
+        impl_type == IMPL_UFFD)
+    {
+        is_shared   = getEnvSize(ENV_SHARED, FALSE);
+        slice_align = getEnvSize(ENV_SLICE_ALIGN, slice_align);
+        slice_block = getEnvSize(ENV_SLICE_BLOCK, 0);
+    }
+    
+    // The variants only apply to the mmap-based baselines
+    if (impl_type == IMPL_MEM || impl_type == IMPL_MMAP)
+    {
+        map_variant = getEnvSize(ENV_MAPVAR, 0);
+    }
+    
+    // Only the memory-based implementations and io_uring (i.e., one ring per
+    // thread) support multiple threads
+    if (num_threads > 1 && impl_type != IMPL_MEM && impl_type != IMPL_MMAP &&
+        impl_type != IMPL_UMMAP && impl_type != IMPL_URING &&
+        impl_type != IMPL_UFFD)
+    {
+        fprintf(stderr, "Error: Multiple threads require MEM/MMAP/UMMAP/"
+                        "URING/UFFD!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The STREAM kernels operate directly on the mapped memory
+    if (benchmark == BENCHMARK_STREAM && impl_type != IMPL_MEM &&
+        impl_type != IMPL_MMAP && impl_type != IMPL_UMMAP &&
+        impl_type != IMPL_UFFD)
+    {
+        fprintf(stderr, "Error: STREAM requires MEM/MMAP/UMMAP/UFFD!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The prefetcher follows the padding patterns on the file-backed
+    // implementations (i.e., the offsets ahead are predictable)
+    if (getenv(ENV_PREFETCH) != NULL &&
+        ((benchmark != BENCHMARK_SEQUENTIAL &&
+          benchmark != BENCHMARK_PADDING) ||
+         (impl_type != IMPL_MMAP && impl_type != IMPL_UMMAP &&
+          impl_type != IMPL_MPIIO && impl_type != IMPL_UFFD)))
+    {
+        fprintf(stderr, "Error: Prefetch requires SEQUENTIAL/PADDING and "
+                        "MMAP/UMMAP/MPIIO/UFFD!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The offsets and the lengths of O_DIRECT must be page-aligned (i.e., the
+    // offsets wrap around the allocation, which must be a fixed size)
+    if (is_direct && ((chunk_size % sysconf(_SC_PAGESIZE)) ||
+                      (alloc_size % chunk_size) || is_dynamic))
+    {
+        fprintf(stderr, "Error: O_DIRECT requires page-aligned chunks and a "
+                        "fixed size multiple of the chunk size!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // At least one timed pass is required (i.e., two for the interval)
+    if (rep.min_passes == 0 || rep.max_passes < rep.min_passes ||
+        (rep.ci_target > 0.0 && rep.min_passes < 2))
+    {
+        fprintf(stderr, "Error: Invalid number of timed passes!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The remote windows must be large enough for the offsets of every rank
+    if (rma_target != RMA_TARGET_SELF && is_dynamic)
+    {
+        fprintf(stderr, "Error: Remote window targets require a fixed "
+                        "size!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The collective operations require the same number of operations on
+    // every process
+    if (mpiio_mode >= MPIIO_COLLECTIVE && is_dynamic)
+    {
+        fprintf(stderr, "Error: Collective MPI-IO requires a fixed size!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The slices are mapped at their offset of the file, so that they must be
+    // page-aligned, and the interleaved blocks require a single mapping
+    if (is_shared && (slice_align == 0 ||
+                      (slice_align % sysconf(_SC_PAGESIZE)) ||
+                      (slice_block % slice_align) ||
+                      (slice_block > 0 && (impl_type != IMPL_MMAP ||
+                                           is_dynamic))))
+    {
+        fprintf(stderr, "Error: Shared slices must be page-aligned, and "
+                        "interleaving requires MMAP with a fixed size!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The intrinsics of the STREAM kernels are only available on x86-64
+    if (kernelGetISA(getEnvSize(ENV_ISA, KERNEL_ISA_AUTO), &isa))
+    {
+        fprintf(stderr, "Error: The instruction set of the kernels is not "
+                        "supported!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // The synchronization of the checkpoints affects the whole process
+    if (benchmark == BENCHMARK_CHECKPOINT &&
+        (num_threads > 1 || alloc_size < chunk_size))
+    {
+        fprintf(stderr, "Error: Checkpoints require a single thread and at "
+                        "least one chunk!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+    }
+    
+    // Parse the dirty fractions of each checkpoint cycle, if requested
+    if (benchmark == BENCHMARK_CHECKPOINT)
+    {
+        const char *dirty_env = getenv(ENV_CKPT_DIRTY);
+        char       *dirty_str = strdup((dirty_env != NULL &&
+                                        *dirty_env != '\0') ? dirty_env :
+                                                               "1,10,50,100");
+        char       *cursor    = dirty_str;
+        
+        ckpt_dirty  = (double *)malloc(sizeof(double) *
+                                       (strlen(dirty_str) + 1));
+        ckpt_layout = getEnvSize(ENV_CKPT_LAYOUT, CKPT_CLUSTERED);
+        
+        // Every fraction must be a number within (0, 100]
+        for (char *token = strsep(&cursor, ","); token != NULL;
+             token = strsep(&cursor, ","))
+        {
+            char         *endptr = NULL;
+            const double value   = strtod(token, &endptr);
+            
+            if (endptr == token || *endptr != '\0' || !(value > 0.0) ||
+                value > 100.0)
+            {
+                fprintf(stderr, "Error: Invalid dirty fraction \"%s\" (i.e., "
+                                "expected within (0, 100])!\n", token);
+                CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+            }
+            
+            ckpt_dirty[num_dirty++] = value;
+        }
+        
+        free(dirty_str);
+    }
+    
+    // Map the binary trace to replay, if requested
+    if (benchmark == BENCHMARK_TRACE)
+    {
+        const char *trace_file = getenv(ENV_TRACE);
+        
+        CHKBPRINT((trace_file == NULL), EINVAL);
+        CHKPRINT(openTrace(trace_file, &trace));
+        
+        // The records of O_DIRECT must also be page-aligned
+        for (uint64_t r = 0; is_direct && r < trace.header->num_records; r++)
+        {
+            const trace_record_t *record = &trace.records[r];
+            
+            if ((record->offset | record->length) % sysconf(_SC_PAGESIZE))
+            {
+                fprintf(stderr, "Error: O_DIRECT requires page-aligned trace "
+                                "records (i.e., record %lu)!\n", r);
+                CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
+            }
+        }
+    }
     
-    // Check if the number of parameters match the expected
-    if (argc < 9 || argc > 10)
+    // Allocate the read / write histograms of each thread, if requested
+    if (getEnvSize(ENV_HIST, FALSE))
     {
-        fprintf(stderr, "Error: The number of parameters is incorrect!\n");
-        fprintf(stderr, "Use: %s %s\n", argv[0], MSTREAM_PARAMS);
-        return -1;
+        hist = (hist_t *)calloc((num_threads << 1), sizeof(hist_t));
     }
     
-    // Initialize MPI and retrieve the rank of the process
-    CHKPRINT(MPI_Init(&argc, &argv));
-    CHKPRINT(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
-    CHKPRINT(MPI_Comm_size(MPI_COMM_WORLD, &num_procs));
-    
-    // Retrieve the benchmark settings
-    sscanf(argv[1], "%zu", &alloc_size);
-    sscanf(argv[2], "%zu", &seg_size);
-    sscanf(argv[3], "%zu", &chunk_size);
-    sscanf(argv[4], "%d",  &benchmark);
-    sscanf(argv[5], "%d",  &impl_type);
-    sscanf(argv[6], "%d",  &read_file);
-    sscanf(argv[7], "%d",  &ptype);
-    sscanf(argv[8], "%d",  &is_dynamic);
+    // Open the counters before the allocation, so that the threads of the
+    // user-space pagers (e.g., ummap-io) inherit them as well
+    if ((is_perf = getEnvSize(ENV_PERF, FALSE)))
+    {
+        perfOpen(&perf);
+    }
     
     // Create the temp. folder according to the settings
     sprintf(tmp_path, "%s/%s/%d_%d_%d_%d_%d", ((argc > 9) ? argv[9] : "."),
@@ -242,6 +1726,87 @@ int main (int argc, char *argv[]) __CHK_FN__
         alloc_size        = (size > alloc_size) ? alloc_size : size;
     }
     
+    // Initialize the skewed distribution over the chunks of each thread, or
+    // the generator of the random offsets, if requested
+    if ((benchmark >= BENCHMARK_ZIPF && benchmark <= BENCHMARK_HOTSPOT) ||
+        ((benchmark == BENCHMARK_PRANDOM || benchmark == BENCHMARK_MIXED) &&
+         rand_type != RAND_LEGACY))
+    {
+        const disttype_t dist_type = (benchmark == BENCHMARK_ZIPF) ? DIST_ZIPF :
+                                     (benchmark == BENCHMARK_HOTCOLD) ?
+                                     DIST_HOTCOLD :
+                                     (benchmark == BENCHMARK_HOTSPOT) ?
+                                     DIST_HOTSPOT :
+                                     (rand_type == RAND_PERMUTATION) ?
+                                     DIST_PERMUTATION :
+                                     (rand_type == RAND_BLOCKED) ?
+                                     DIST_BLOCKED : DIST_UNIFORM;
+        const size_t     num_items = (num_threads > 1 &&
+                                      layout == LAYOUT_DISJOINT) ?
+                                     (alloc_size / num_threads / chunk_size) :
+                                     (alloc_size / chunk_size);
+        
+        distInit(&dist, dist_type, num_items, (rank + 1) * 921,
+                 getEnvDouble(ENV_SKEW, 0.99),
+                 getEnvDouble(ENV_HOT_ACCESS, 90.0),
+                 getEnvDouble(ENV_HOT_DATA, 10.0),
+                 getEnvSize(ENV_HOT_MOVE, num_items),
+                 getEnvSize(ENV_RAND_BLOCK, 16));
+    }
+    
+    file_size = alloc_size;
+    
+    // Place the slice of each process in a single file, either consecutive
+    // (i.e., after the slices of the lower ranks) or interleaved by blocks
+    if (is_shared)
+    {
+        const uint64_t slice_size = ((alloc_size + slice_align - 1) /
+                                     slice_align) * slice_align;
+        
+        if (slice_block > 0)
+        {
+            file_offset = slice_block * rank;
+            file_size   = ((alloc_size + slice_block - 1) / slice_block) *
+                          slice_block * num_procs;
+        }
+        else
+        {
+            CHKPRINT(MPI_Exscan(&slice_size, &file_offset, 1, MPI_UINT64_T,
+                                MPI_SUM, MPI_COMM_WORLD));
+            CHKPRINT(MPI_Allreduce(&slice_size, &file_size, 1, MPI_UINT64_T,
+                                   MPI_SUM, MPI_COMM_WORLD));
+            file_offset = (rank > 0) ? file_offset : 0;
+        }
+        
+        sprintf(filename, "%s/mstream.tmp", tmp_path);
+    }
+    
+    // Pin the main thread before allocating the resources, so that the
+    // buffers of every implementation follow the placement
+    is_numa = (getenv(ENV_NUMA) != NULL);
+    CHKPRINT(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                                 MPI_INFO_NULL, &comm_node));
+    CHKPRINT(MPI_Comm_rank(comm_node, &local_rank));
+    CHKPRINT(MPI_Comm_free(&comm_node));
+    CHKPRINT(numaInit(&numa, getEnvSize(ENV_NUMA, NUMA_POLICY_NONE),
+                      local_rank, num_threads));
+    CHKPRINT(numaSetThread(&numa, 0));
+    
+    // Sample the footprint of the process from this point, if requested
+    if ((is_mem = getEnvSize(ENV_MEM, FALSE)))
+    {
+        CHKPRINT(memstatStart(&memstat, getEnvSize(ENV_MEM_INT, 100)));
+        memstatPhase(&memstat, "init");
+    }
+    
+    // Record the available memory of the node before the allocation, so that
+    // the budget of the out-of-core sweep excludes the resident pages
+    if (getenv(ENV_OOC) != NULL)
+    {
+        CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+        mem_avail = getMemAvailable();
+    }
+    
     // Allocate the corresponding resources
     switch (impl_type)
     {
@@ -260,39 +1825,91 @@ int main (int argc, char *argv[]) __CHK_FN__
             CHKPRINT(MPI_Win_allocate(alloc_size, sizeof(char), info,
                                       MPI_COMM_WORLD, (void**)&baseptr, &win));
             
-            // Lock the window in exclusive mode
-            CHKPRINT(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rank, 0, win));
+            // Lock the window in exclusive mode, or every window in shared
+            // mode for the remote targets
+            CHKPRINT(rmaInit(&rma, win, rma_target,
+                             getEnvSize(ENV_RMA_BATCH, 1),
+                             ((benchmark == BENCHMARK_TRACE &&
+                               trace.header->max_length > chunk_size) ?
+                              trace.header->max_length : chunk_size)));
         } break;
         
         case IMPL_MPIIO:
         {
+            const char *hints_env       = getenv(ENV_MPIIO_HINTS);
+            char       hints[PATH_MAX] = { 0 };
+            
+            // Bypass the page cache through the hints of ROMIO, if requested
+            snprintf(hints, PATH_MAX, "%s%s%s",
+                     (is_direct) ? "direct_read=true,direct_write=true" : "",
+                     (is_direct && hints_env != NULL) ? "," : "",
+                     (hints_env != NULL) ? hints_env : "");
+            
+            // The shared modes place the region of every process in a single
+            // file (i.e., described by the view of each process)
+            if (mpiio_mode != MPIIO_PRIVATE)
+            {
+                sprintf(filename, "%s/mstream.tmp", tmp_path);
+            }
+            
             // Open the target file using MPI I/O
-            CHKPRINT(MPI_File_open(MPI_COMM_SELF, filename, MPIIO_FLAGS,
-                                   MPI_INFO_NULL, &file));
-            CHKPRINT(MPI_File_preallocate(file, alloc_size));
+            CHKPRINT(mpiioOpen(&mpiio, filename, MPIIO_FLAGS, alloc_size,
+                               mpiio_mode, hints,
+                               getEnvSize(ENV_MPIIO_DEPTH, 2),
+                               ((benchmark == BENCHMARK_TRACE &&
+                                 trace.header->max_length > chunk_size) ?
+                                trace.header->max_length : chunk_size)));
+        } break;
+        
+        case IMPL_URING:
+        {
+            const int direct_flags = (is_direct) ? O_DIRECT : 0;
+            
+            // The file remains open, as the rings are created per thread
+            CHKPRINT(openFile(filename, (POSIX_FLAGS | direct_flags), TRUE,
+                              alloc_size, &fd));
+        } break;
+        
+        case IMPL_UFFD:
+        {
+            const uffdptype_t uffd_ptype = (ptype == UMMAP_PTYPE_PLRU) ?
+                                           UFFD_PTYPE_LRU : UFFD_PTYPE_FIFO;
+            
+            // The file remains open, as the pager reads / writes segments
+            CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE, file_size, &fd));
+            CHKPRINT(uffdMap(alloc_size, seg_size, fd, file_offset,
+                             getEnvSize(ENV_UFFD_BUDGET, 0), read_file,
+                             uffd_ptype, &uffd, (void **)&baseptr));
         } break;
         
         default: // IMPL_MEM + IMPL_MMAP + IMPL_UMMAP
         {
-            const uint32_t flush_int  = UINT_MAX; // <<<<<<<<<<<<<<<<<
             const int32_t  mmap_flags = (impl_type == IMPL_MEM) ? MMAP_FLAGS_M :
                                                                   MMAP_FLAGS;
             
             if (impl_type != IMPL_MEM)
             {
-                CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE, alloc_size,
+                CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE, file_size,
                                   &fd));
             }
             
             if (impl_type == IMPL_UMMAP)
             {
-                CHKPRINT(ummap(alloc_size, seg_size, PROT_FULL, fd, 0,
+                CHKPRINT(ummap(alloc_size, seg_size, PROT_FULL, fd, file_offset,
                                flush_int, read_file, ptype, (void **)&baseptr));
             }
+            else if (slice_block > 0)
+            {
+                CHKPRINT(mapInterleaved(alloc_size, PROT_FULL, mmap_flags, fd,
+                                        file_offset, slice_block,
+                                        (slice_block * num_procs), map_variant,
+                                        (void **)&baseptr));
+            }
             else
             {
-                baseptr = mmap(NULL, alloc_size, PROT_FULL, mmap_flags, fd, 0);
-                CHKBPRINT((baseptr == MAP_FAILED), errno);
+                CHKPRINT(mapMemory(alloc_size, PROT_FULL, mmap_flags, fd,
+                                   file_offset, map_variant,
+                                   (void **)&baseptr));
             }
             
             if (impl_type != IMPL_MEM)
@@ -302,79 +1919,217 @@ int main (int argc, char *argv[]) __CHK_FN__
         }
     }
     
+    // Bind the mapping to the memory node(s), migrating the resident pages
+    if (impl_type == IMPL_MEM || impl_type == IMPL_MMAP ||
+        impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD)
+    {
+        CHKPRINT(numaBind(&numa, baseptr, alloc_size));
+    }
+    
+    // Set the page cache state of the region of the process in the file
+    // (i.e., each process covers an equal share of the interleaved file)
+    cache_off  = (impl_type == IMPL_MPIIO) ? mpiio.disp :
+                 (slice_block > 0) ? (file_size / num_procs) * rank :
+                                     file_offset;
+    cache_size = (slice_block > 0) ? (file_size / num_procs) : alloc_size;
+    
+    CHKPRINT(applyCacheState(impl_type, baseptr, alloc_size, filename,
+                             cache_off, cache_size, cache_state, FALSE));
+    
+    if (is_mem)
+    {
+        memstatPhase(&memstat, "alloc");
+    }
+    
     // Force all processes to wait before starting the benchmark
     CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
     
-    // Launch the benchmark
-    for (uint32_t iteration = 0; iteration < NUM_ITER_TOTAL; iteration++)
+    // Launch the benchmark (the main thread acts as the first thread)
+    bthread = (bmark_thread_t *)calloc(num_threads, sizeof(bmark_thread_t));
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+    CHKPRINT(pthread_barrier_init(&barrier, NULL, num_threads));
+    rep.pass_time = (uint64_t *)calloc(num_threads * rep.max_passes,
+                                       sizeof(uint64_t));
+    
+    for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
     {
-        // Start the timer after the initial iterations
-        if (iteration == NUM_ITER_INIT)
+        bthread[thread_id].impl_type   = impl_type;
+        bthread[thread_id].benchmark   = benchmark;
+        bthread[thread_id].baseptr     = baseptr;
+        bthread[thread_id].win         = win;
+        bthread[thread_id].mpiio       = &mpiio;
+        bthread[thread_id].rank        = rank;
+        bthread[thread_id].is_dynamic  = is_dynamic;
+        bthread[thread_id].alloc_size  = alloc_size;
+        bthread[thread_id].chunk_size  = chunk_size;
+        bthread[thread_id].thread_id   = thread_id;
+        bthread[thread_id].num_threads = num_threads;
+        bthread[thread_id].layout      = layout;
+        bthread[thread_id].hist        = (hist != NULL) ?
+                                         &hist[thread_id << 1] : NULL;
+        bthread[thread_id].trace       = &trace;
+        bthread[thread_id].is_think    = getEnvSize(ENV_THINK, FALSE);
+        bthread[thread_id].dist        = dist;
+        distSeed(&bthread[thread_id].dist, (rank + 1) * 921 + thread_id * 7919);
+        bthread[thread_id].barrier     = &barrier;
+        bthread[thread_id].perf        = (is_perf) ? &perf : NULL;
+        bthread[thread_id].read_file   = read_file;
+        bthread[thread_id].isa         = isa;
+        bthread[thread_id].is_nt       = (getEnvSize(ENV_NT, FALSE) &&
+                                          isa >= KERNEL_ISA_AVX2);
+        bthread[thread_id].uffd        = uffd;
+        bthread[thread_id].ckpt_dirty  = ckpt_dirty;
+        bthread[thread_id].num_dirty   = num_dirty;
+        bthread[thread_id].ckpt_layout = ckpt_layout;
+        bthread[thread_id].rma         = &rma;
+        bthread[thread_id].rep         = &rep;
+        bthread[thread_id].numa        = &numa;
+        
+        if (benchmark == BENCHMARK_CHECKPOINT)
         {
-            clock_gettime(CLOCK_REALTIME, &start[0]);
-            clock_gettime(CLOCK_REALTIME, &start[2]);
-            
-            if (is_dynamic)
-            {
-                usleep(rank * 921921);
-            }
+            bthread[thread_id].ckpt_cycles = (ckpt_cycle_t *)malloc(
+                                              sizeof(ckpt_cycle_t) *
+                                              num_dirty * (rep.num_warmup +
+                                                           rep.max_passes));
         }
         
-        switch (benchmark)
+        if (impl_type == IMPL_URING)
         {
-            case BENCHMARK_SEQUENTIAL:
-                CHK(launchBenchmark(impl_type, baseptr, win, file, FALSE, rank,
-                                    alloc_size, alloc_size, chunk_size,
-                                    chunk_size)); break;
-            case BENCHMARK_PADDING:
-                CHK(launchBenchmark(impl_type, baseptr, win, file, FALSE, rank,
-                                    alloc_size, alloc_size, chunk_size,
-                                    (chunk_size << 1))); break;
-            case BENCHMARK_PRANDOM:
-                CHK(launchBenchmark(impl_type, baseptr, win, file, TRUE, rank,
-                                    alloc_size, alloc_size, chunk_size, 0));
-                                    break;
-            case BENCHMARK_MIXED:
-                CHK(launchBenchmark(impl_type, baseptr, win, file, TRUE, rank,
-                                    alloc_size, (alloc_size >> 1), chunk_size,
-                                    0));
-                CHK(launchBenchmark(impl_type, baseptr, win, file, FALSE, rank,
-                                    alloc_size, (alloc_size >> 1), chunk_size,
-                                    (chunk_size << 1)));
+            const size_t max_length = (benchmark == BENCHMARK_TRACE &&
+                                       trace.header->max_length > chunk_size) ?
+                                      trace.header->max_length : chunk_size;
+            
+            CHKPRINT(uringInit(&bthread[thread_id].uring, fd,
+                               getEnvSize(ENV_URING_QD, 32),
+                               getEnvSize(ENV_URING_BATCH, 8), max_length,
+                               getEnvSize(ENV_URING_FIXED, 0)));
         }
     }
     
-    // Synchronize the resources
-    clock_gettime(CLOCK_REALTIME, &start[1]);
-    switch (impl_type)
+    iter_size = (benchmark == BENCHMARK_TRACE) ? trace.header->total_size :
+                                                 alloc_size;
+    
+    // Each STREAM iteration moves the bytes of the four kernels
+    if (benchmark == BENCHMARK_STREAM)
     {
-        case IMPL_MPI1SM:
-        case IMPL_MPI1SS:
+        iter_size = 0;
+        
+        for (int type = 0; type < KERNEL_NUM_TYPES; type++)
         {
-            CHKPRINT(MPI_Win_sync(win));
-        } break;
+            iter_size += kernelGetBytes(type) * STREAM_ELEMS(alloc_size);
+        }
+    }
+    
+    // Each checkpoint iteration only dirties the requested fractions
+    if (benchmark == BENCHMARK_CHECKPOINT)
+    {
+        iter_size = 0;
         
-        case IMPL_MPIIO:
+        for (uint32_t i = 0; i < num_dirty; i++)
         {
-            CHKPRINT(MPI_File_sync(file));
-        } break;
+            iter_size += (size_t)((alloc_size / chunk_size) *
+                                  ckpt_dirty[i] / 100.0) * chunk_size;
+        }
+    }
+    
+    // Launch the sampler over the progress of every thread, if requested
+    if (sample_int > 0)
+    {
+        progress = (const progress_t **)malloc(sizeof(progress_t *) *
+                                               num_threads);
         
-        case IMPL_UMMAP:
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
         {
-            CHKPRINT(umsync(baseptr, FALSE));
-        } break;
+            memset(&bthread[thread_id].progress, 0, sizeof(progress_t));
+            progress[thread_id] = &bthread[thread_id].progress;
+        }
         
-        default: // IMPL_MEM + IMPL_MMAP
+        // The intervals of every process start at the same time, so that
+        // the merged series is aligned
+        CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+        CHKPRINT(samplerStart(&sampler, progress, num_threads, sample_int));
+    }
+    
+    CHKPRINT(launchThreads(bthread, threads));
+    
+    if (is_mem)
+    {
+        memstatPhase(&memstat, "access");
+    }
+    
+    // Accumulate the histograms of the threads into the main thread
+    for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+    {
+        if (hist != NULL)
         {
-            CHKPRINT(msync(baseptr, alloc_size, MS_SYNC));
+            histMerge(&hist[HIST_READ],  &hist[(thread_id << 1) + HIST_READ]);
+            histMerge(&hist[HIST_WRITE], &hist[(thread_id << 1) + HIST_WRITE]);
         }
     }
+    
+    start[0] = bthread[0].start;
+    start[2] = bthread[0].start;
+    
+    // Synchronize the resources
+    if (is_perf)
+    {
+        perf_sample[0] = bthread[0].perf_start;
+        perfRead(&perf, &perf_sample[1]);
+    }
+    
+    if (impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD)
+    {
+        pager_sample[0] = bthread[0].pager_start;
+        CHKPRINT(getPagerSample(impl_type, uffd, read_file,
+                                &pager_sample[1]));
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &start[1]);
+    CHKPRINT(syncResources(&bthread[0], uffd));
     clock_gettime(CLOCK_REALTIME, &stop[1]);
+    
+    // The sampler also covers the synchronization (e.g., flush stalls)
+    if (sample_int > 0)
+    {
+        CHKPRINT(samplerStop(&sampler));
+    }
+    
     clock_gettime(CLOCK_REALTIME, &stop[0]);
     
+    if (is_mem)
+    {
+        memstatPhase(&memstat, "sync");
+        CHKPRINT(memstatStop(&memstat));
+    }
+    
+    if (is_perf)
+    {
+        perfRead(&perf, &perf_sample[2]);
+    }
+    
     CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
     clock_gettime(CLOCK_REALTIME, &stop[2]);
     
+    // Convert the snapshots into the counters of each phase (i.e., access
+    // loop, synchronization and barrier-inclusive total)
+    if (is_perf)
+    {
+        perfRead(&perf, &perf_sample[3]);
+        perfDiff(&perf_sample[0], &perf_sample[3], &perf_sample[3]);
+        perfDiff(&perf_sample[1], &perf_sample[2], &perf_sample[2]);
+        perfDiff(&perf_sample[0], &perf_sample[1], &perf_sample[1]);
+    }
+    
+    // Summarize the timed passes (i.e., the slowest thread of each pass)
+    getPassStats(&bthread[0], &pass_stats);
+    
+    // Sample the location of the pages of the mapping, if requested
+    if (is_numa && (impl_type == IMPL_MEM || impl_type == IMPL_MMAP ||
+                    impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD))
+    {
+        CHKPRINT(numaGetPlacement(&numa, baseptr, alloc_size, &numa_place));
+    }
+    
     // Print the result (in order)
     for (int drank = 0; drank < num_procs; drank++)
     {
@@ -383,7 +2138,7 @@ int main (int argc, char *argv[]) __CHK_FN__
         if (drank == rank)
         {
             size_t   alloc_size_all   = alloc_size * num_procs;
-            size_t   wsize            = alloc_size * NUM_ITER;
+            size_t   wsize            = iter_size * bthread[0].num_passes;
             double   elapsed          = getElapsed(start[0], stop[0], TSUNIT_SEC);
             double   elapsed_flush    = getElapsed(start[1], stop[1], TSUNIT_SEC);
             double   elapsed_all      = getElapsed(start[2], stop[2], TSUNIT_SEC);
@@ -394,14 +2149,329 @@ int main (int argc, char *argv[]) __CHK_FN__
             uint32_t num_reads        = 0;
             uint32_t num_writes       = 0;
             
-            CHKPRINT(umstats(&num_reads, &num_writes));
+            CHKPRINT(getPagerStats(impl_type, uffd, &num_reads, &num_writes));
             
             printf("%d;%d; %zu;%zu;%zu;%zu;%d;%d;%d;%d; %lf;%lf;%lf;%lf;%lf; " \
-                   "%d;%d\n", rank, num_procs, alloc_size, alloc_size_all,
-                   seg_size, chunk_size, benchmark, impl_type, read_file, ptype,
-                   elapsed, elapsed_flush, bandwidth_mb, elapsed_all,
-                   bandwidth_all_mb, num_reads, num_writes);
+                   "%d;%d; %d; %d;%d\n", rank, num_procs, alloc_size,
+                   alloc_size_all, seg_size, chunk_size, benchmark, impl_type,
+                   read_file, ptype, elapsed, elapsed_flush, bandwidth_mb,
+                   elapsed_all, bandwidth_all_mb, num_reads, num_writes,
+                   map_variant, cache_state, is_direct);
+            
+            // Print the hit ratio and the I/O of the eviction policy over the
+            // timed passes, if the access distribution is skewed and the
+            // segments filled by the pager are known
+            if (benchmark >= BENCHMARK_ZIPF && benchmark <= BENCHMARK_HOTSPOT &&
+                (impl_type == IMPL_UFFD ||
+                 (impl_type == IMPL_UMMAP && read_file)))
+            {
+                const pagersample_t *pager    = pager_sample;
+                const uint32_t      num_fills = pager[1].num_fills -
+                                                pager[0].num_fills;
+                const uint32_t      num_io    = (pager[1].num_reads -
+                                                 pager[0].num_reads) +
+                                                (pager[1].num_writes -
+                                                 pager[0].num_writes);
+                double              num_ops   = (double)(wsize / chunk_size);
+                double              hit_ratio = 1.0 - (num_fills / num_ops);
+                double              io_mb     = ((double)num_io * seg_size) /
+                                                1048576.0;
+                
+                printf("policy;%d;%d;%d; %.0lf;%lf;%lf\n", rank, benchmark,
+                       ptype, num_ops, ((hit_ratio > 0.0) ? hit_ratio : 0.0),
+                       io_mb);
+            }
+            
+            // Print the bandwidth of each thread, if more than one was used
+            for (uint32_t thread_id = 0; thread_id < num_threads &&
+                                         num_threads > 1; thread_id++)
+            {
+                double elapsed_t = getElapsed(bthread[thread_id].start,
+                                              bthread[thread_id].stop,
+                                              TSUNIT_SEC);
+                
+                printf("thread;%d;%u;%u;%d; %lf;%lf\n", rank, thread_id,
+                       num_threads, layout, elapsed_t,
+                       ((wsize / num_threads) / elapsed_t) / 1048576.0);
+            }
+            
+            // Print the bandwidth of each STREAM kernel (average and best)
+            for (int type = 0; type < KERNEL_NUM_TYPES &&
+                               benchmark == BENCHMARK_STREAM; type++)
+            {
+                const double bytes = (double)kernelGetBytes(type) *
+                                     STREAM_ELEMS(alloc_size);
+                
+                printf("stream;%d;%s;%d;%d; %lf;%lf\n", rank,
+                       kernelGetName(type), isa, bthread[0].is_nt,
+                       (bytes * bthread[0].num_passes /
+                        bthread[0].kernel_time[type]) *
+                       (1000000000.0 / 1048576.0),
+                       (bytes / bthread[0].kernel_min[type]) *
+                       (1000000000.0 / 1048576.0));
+            }
+            
+            // Print the latency and the data written of each checkpoint cycle
+            for (uint32_t i = 0; i < bthread[0].num_cycles; i++)
+            {
+                const ckpt_cycle_t *ckpt = &bthread[0].ckpt_cycles[i];
+                
+                printf("ckpt;%d;%lf;%d;%u; %zu;%lf;%u;%zu\n", rank,
+                       ckpt->dirty_pct, ckpt_layout, ckpt->cycle,
+                       ckpt->dirty_size, ckpt->latency, ckpt->num_writes,
+                       ckpt->write_bytes);
+            }
+            
+            // Print the summary of the timed passes
+            printf("rep;%d;%u;%u;%u; %lf;%lf;%lf;%lf\n", rank, rep.num_warmup,
+                   bthread[0].num_passes, pass_stats.num_outliers,
+                   pass_stats.mean, pass_stats.median, pass_stats.stddev,
+                   pass_stats.ci);
+            
+            // Print the placement of the process and of each thread
+            if (is_numa)
+            {
+                printf("numa;%d;%d;%d;%d;%d; %u;%u;%u\n", rank, numa.policy,
+                       numa.cpu_node, numa.mem_node, numa.num_nodes,
+                       numa_place.num_local, numa_place.num_remote,
+                       numa_place.num_absent);
+                
+                for (uint32_t thread_id = 0; thread_id < num_threads;
+                     thread_id++)
+                {
+                    printf("numa_cpu;%d;%u;%d;%d\n", rank, thread_id,
+                           bthread[thread_id].cpu,
+                           bthread[thread_id].cpu_node);
+                }
+            }
+            
+            // Print the targets and the batch of the window operations
+            if (impl_type == IMPL_MPI1SM || impl_type == IMPL_MPI1SS)
+            {
+                printf("rma;%d;%d;%u\n", rank, rma.target, rma.batch);
+            }
+            
+            // Print the generator of the random offsets, if requested
+            if (bthread[0].dist.type >= DIST_PERMUTATION ||
+                (bthread[0].dist.type == DIST_UNIFORM &&
+                 bthread[0].dist.num_items > 0))
+            {
+                printf("rand;%d;%d;%lu; %lu\n", rank, rand_type,
+                       (unsigned long)bthread[0].dist.block_items,
+                       (unsigned long)bthread[0].dist.num_items);
+            }
+            
+            // Print the slice of the shared backing file
+            if (is_shared)
+            {
+                printf("shared;%d;%lu;%lu; %lu;%lu\n", rank,
+                       (unsigned long)slice_align, (unsigned long)slice_block,
+                       (unsigned long)file_offset, (unsigned long)file_size);
+            }
+            
+            // Print the mode and the region of the file
+            if (impl_type == IMPL_MPIIO)
+            {
+                printf("mpiio;%d;%d;%u;%lld\n", rank, mpiio.mode, mpiio.depth,
+                       (long long)mpiio.disp);
+            }
+            
+            // Print the counters of each phase, if requested
+            for (int phase = 0; phase < 3 && is_perf; phase++)
+            {
+                const int64_t *value = perf_sample[phase + 1].value;
+                
+                printf("perf;%d;%s; %ld;%ld;%ld;%ld;%ld;%ld;%ld\n", rank,
+                       perf_phase[phase], value[PERF_MINFLT],
+                       value[PERF_MAJFLT], value[PERF_DTLB], value[PERF_LLC],
+                       value[PERF_CSW], value[PERF_CYCLES], value[PERF_INSTR]);
+            }
+        }
+    }
+    
+    // Accumulate the counters of all the processes and print the result
+    for (int phase = 0; phase < 3 && is_perf; phase++)
+    {
+        perfsample_t  sample_all = { { 0 } };
+        const int64_t *value     = sample_all.value;
+        
+        CHKPRINT(perfReduce(&perf_sample[phase + 1], &sample_all, 0,
+                            MPI_COMM_WORLD));
+        
+        if (rank == 0)
+        {
+            printf("perf;all;%s; %ld;%ld;%ld;%ld;%ld;%ld;%ld\n",
+                   perf_phase[phase], value[PERF_MINFLT], value[PERF_MAJFLT],
+                   value[PERF_DTLB], value[PERF_LLC], value[PERF_CSW],
+                   value[PERF_CYCLES], value[PERF_INSTR]);
+        }
+    }
+    
+    // Summarize the metrics of all the processes (i.e., the spread between
+    // them) and print the result
+    rep_value[0] = pass_stats.mean;
+    rep_value[1] = (pass_stats.mean > 0.0) ?
+                   (iter_size / pass_stats.mean) / 1048576.0 : 0.0;
+    rep_value[2] = getElapsed(start[0], stop[0], TSUNIT_SEC);
+    rep_value[3] = getElapsed(start[1], stop[1], TSUNIT_SEC);
+    
+    for (int metric = 0; metric < 4; metric++)
+    {
+        CHKPRINT(statsReduce(rep_value[metric], &rep_stats[metric], 0,
+                             MPI_COMM_WORLD));
+        
+        if (rank == 0)
+        {
+            printf("rep;all;%s; %lf;%lf;%lf;%lf;%lf\n", rep_metric[metric],
+                   rep_stats[metric].min, rep_stats[metric].median,
+                   rep_stats[metric].max, rep_stats[metric].mean,
+                   rep_stats[metric].stddev);
+        }
+    }
+    
+    // Print the footprint of each process and the total of all of them
+    if (is_mem)
+    {
+        CHKPRINT(memstatPrint(&memstat, mem_total, 0, MPI_COMM_WORLD));
+        memstatFree(&memstat);
+    }
+    
+    // Append the self-describing record of the run, if requested
+    if (rank == 0 && getenv(ENV_JSON) != NULL && *getenv(ENV_JSON) != '\0')
+    {
+        CHKPRINT(recordOpen(&record, getenv(ENV_JSON)));
+        
+        recordBegin(&record, "config");
+        recordInt(&record, "alloc_size",  alloc_size);
+        recordInt(&record, "seg_size",    seg_size);
+        recordInt(&record, "chunk_size",  chunk_size);
+        recordInt(&record, "benchmark",   benchmark);
+        recordInt(&record, "impl_type",   impl_type);
+        recordInt(&record, "read_file",   read_file);
+        recordInt(&record, "ptype",       ptype);
+        recordInt(&record, "is_dynamic",  is_dynamic);
+        recordInt(&record, "num_procs",   num_procs);
+        recordInt(&record, "num_threads", num_threads);
+        recordInt(&record, "iter_size",   iter_size);
+        recordInt(&record, "cache",       cache_state);
+        recordInt(&record, "direct",      is_direct);
+        recordEnd(&record);
+        
+        recordEnv(&record, "env", "MSTREAM_");
+        recordHost(&record, "host");
+        
+        recordBegin(&record, "passes");
+        recordInt(&record,    "warmup",    rep.num_warmup);
+        recordInt(&record,    "passes",    bthread[0].num_passes);
+        recordDouble(&record, "ci_target", rep.ci_target);
+        recordDouble(&record, "outlier_z", rep.outlier_z);
+        recordStats(&record,  "time",      &pass_stats);
+        recordEnd(&record);
+        
+        if (is_numa)
+        {
+            recordBegin(&record, "numa");
+            recordInt(&record, "policy",   numa.policy);
+            recordInt(&record, "cpu_node", numa.cpu_node);
+            recordInt(&record, "mem_node", numa.mem_node);
+            recordInt(&record, "local",    numa_place.num_local);
+            recordInt(&record, "remote",   numa_place.num_remote);
+            recordInt(&record, "absent",   numa_place.num_absent);
+            recordEnd(&record);
+        }
+        
+        if (is_mem)
+        {
+            recordBegin(&record, "memory");
+            recordInt(&record, "interval_ms", memstat.interval_ms);
+            
+            for (int field = 0; field < MEMSTAT_NUM_FIELDS; field++)
+            {
+                char name[32];
+                
+                sprintf(name, "peak_sum_%s", memstatGetName(field));
+                recordInt(&record, name, mem_total[0].value[field]);
+                sprintf(name, "steady_%s", memstatGetName(field));
+                recordInt(&record, name, mem_total[1].value[field]);
+            }
+            
+            recordEnd(&record);
+        }
+        
+        recordBegin(&record, "ranks");
+        
+        for (int metric = 0; metric < 4; metric++)
+        {
+            recordStats(&record, rep_metric[metric], &rep_stats[metric]);
+        }
+        
+        recordEnd(&record);
+        CHKPRINT(recordClose(&record));
+    }
+    
+    // Print the time series of each process (and the merged one, if requested)
+    if (sample_int > 0)
+    {
+        if (rank == 0)
+        {
+            printf("sampler;%u;%u\n", sample_int, flush_int);
+        }
+        
+        CHKPRINT(samplerPrint(&sampler, getEnvSize(ENV_SAMPLE_ALL, FALSE), 0,
+                              MPI_COMM_WORLD));
+        samplerFree(&sampler);
+        free(progress);
+    }
+    
+    // Merge the histograms of all the processes and print the percentiles
+    if (hist != NULL)
+    {
+        const char *hist_op[2] = { "read", "write" };
+        hist_t     *hist_all   = (hist_t *)calloc(1, sizeof(hist_t));
+        
+        for (int op = HIST_READ; op <= HIST_WRITE; op++)
+        {
+            memset(hist_all, 0, sizeof(hist_t));
+            CHKPRINT(histReduce(&hist[op], hist_all, 0, MPI_COMM_WORLD));
+            
+            if (rank == 0)
+            {
+                printf("hist;%s; %lu; %lf;%lf;%lf;%lf;%lf\n", hist_op[op],
+                       (unsigned long)hist_all->count,
+                       histPercentile(hist_all, 50.0)  / 1000.0,
+                       histPercentile(hist_all, 90.0)  / 1000.0,
+                       histPercentile(hist_all, 99.0)  / 1000.0,
+                       histPercentile(hist_all, 99.9)  / 1000.0,
+                       hist_all->max / 1000.0);
+            }
         }
+        
+        free(hist_all);
+        free(hist);
+    }
+    
+    // Sweep the ratio of working set to resident budget, if requested. The
+    // sweeps follow the regular benchmark, so that their I/O and footprint
+    // are not included in the figures above (e.g., the mapping is resident)
+    if (getenv(ENV_OOC) != NULL)
+    {
+        CHKPRINT(launchOutOfCore(bthread, threads, uffd, iter_size,
+                                 mem_avail, getenv(ENV_OOC)));
+    }
+    
+    // Sweep the distance of the prefetcher, if requested
+    if (getenv(ENV_PREFETCH) != NULL)
+    {
+        CHKPRINT(launchPrefetchSweep(bthread, threads, uffd, iter_size,
+                                     getenv(ENV_PREFETCH), filename,
+                                     cache_off, cache_size, cache_state));
+    }
+    
+    CHKPRINT(pthread_barrier_destroy(&barrier));
+    
+    if (benchmark == BENCHMARK_TRACE)
+    {
+        CHKPRINT(closeTrace(&trace));
     }
     
     // Release the resources
@@ -410,13 +2480,29 @@ int main (int argc, char *argv[]) __CHK_FN__
         case IMPL_MPI1SM:
         case IMPL_MPI1SS:
         {
-            CHKPRINT(MPI_Win_unlock(rank, win));
+            CHKPRINT(rmaFree(&rma));
             CHKPRINT(MPI_Win_free(&win));
         } break;
         
         case IMPL_MPIIO:
         {
-            CHKPRINT(MPI_File_close(&file));
+            CHKPRINT(mpiioClose(&mpiio));
+        } break;
+        
+        case IMPL_URING:
+        {
+            for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+            {
+                CHKPRINT(uringFree(&bthread[thread_id].uring));
+            }
+            
+            CHKPRINT(close(fd));
+        } break;
+        
+        case IMPL_UFFD:
+        {
+            CHKPRINT(uffdUnmap(uffd, FALSE));
+            CHKPRINT(close(fd));
         } break;
         
         case IMPL_UMMAP:
@@ -426,10 +2512,25 @@ int main (int argc, char *argv[]) __CHK_FN__
         
         default: // IMPL_MEM + IMPL_MMAP
         {
-            CHKPRINT(munmap(baseptr, alloc_size));
+            CHKPRINT(unmapMemory(baseptr, alloc_size, map_variant));
         }
     }
     
+    for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+    {
+        free(bthread[thread_id].ckpt_cycles);
+    }
+    
+    free(threads);
+    free(bthread);
+    free(ckpt_dirty);
+    free(rep.pass_time);
+    
+    if (is_perf)
+    {
+        perfClose(&perf);
+    }
+    
     // Force all processes to wait before finalizing the MPI session
     CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
     
@@ -1,23 +1,183 @@
 
 #include "common.h"
 #include "util.h"
+#include "hist.h"
+#include "uffd.h"
 #include "ummap.h"
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <pthread.h>
 #include <mpi.h>
 
 #define PFLATENCY_PARAMS "[size] [impl] [num_alloc] [folder] [seg_size]"
 #define TMP_FILE         "pflatency_test.tmp"
 #define PROT_FULL        (PROT_READ   | PROT_WRITE)
+#define MMAP_FLAGS       (MAP_SHARED  | MAP_NORESERVE)
 #define MMAP_FLAGS_M     (MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS)
 #define POSIX_FLAGS      (O_CREAT     | O_RDWR)
+#define ENV_THREADS      "PFLATENCY_THREADS" // Number of threads per process
+#define ENV_OVERLAP      "PFLATENCY_OVERLAP" // Overlapping pages (0 = Disjoint)
+#define ENV_HIST         "PFLATENCY_HIST"    // Per-fault timing (0 = Disabled)
+#define ENV_MAPVAR       "PFLATENCY_MAPVAR"  // MEM / MMAP variant (MAPVAR_*)
+#define ENV_MODE         "PFLATENCY_MODE"    // Fault type (ModeType)
+#define ENV_ORDER        "PFLATENCY_ORDER"   // Page order (OrderType)
+#define ENV_STRIDE       "PFLATENCY_STRIDE"  // Pages per stride (ORDER_STRIDED)
+#define ENV_SWEEP        "PFLATENCY_SWEEP"   // Sweep seg_size (0 = No)
 
 enum ImplType
 {
     IMPL_MEM = 0, // 0
-    IMPL_MMAP,    // 1 << Ignored
-    IMPL_UMMAP    // 2
+    IMPL_MMAP,    // 1 << Only file-backed on the read modes
+    IMPL_UMMAP,   // 2
+    IMPL_UFFD = 7 // 7 << Same value as in mstream
 };
 
+enum ModeType
+{
+    MODE_WRITE = 0, // 0 << Write faults
+    MODE_READ,      // 1 << Read faults, backing file evicted from the cache
+    MODE_READ_FILL  // 2 << Read faults, right after filling the backing file
+};
+
+enum OrderType
+{
+    ORDER_FORWARD = 0, // 0
+    ORDER_REVERSE,     // 1
+    ORDER_STRIDED,     // 2 << Every N-th page, then the next offset
+    ORDER_RANDOM       // 3
+};
+
+/**
+ * Structure that contains the settings and the results of the page-fault test
+ * for each of the threads of the process.
+ */
+typedef struct
+{
+    char              **baseptr;
+    int               num_alloc;
+    off_t             *offsets;
+    size_t            num_pages;
+    int               is_write;
+    int               is_overlap;
+    uint64_t          checksum;
+    hist_t            *hist;
+    pthread_barrier_t *barrier;
+    long              num_minflt;
+    long              num_majflt;
+} pf_thread_t;
+
+/**
+ * Helper method that lists the offsets of the given range of pages in the
+ * requested order.
+ */
+static void orderPages(off_t *offsets, size_t num_pages, off_t offset_start,
+                       size_t padding, int order, size_t stride, uint32_t seed)
+{
+    size_t page = 0;
+    
+    stride = (order == ORDER_STRIDED && stride > 0) ? stride : 1;
+    
+    // The strided order visits every N-th page, starting at each offset
+    for (size_t first = 0; first < stride; first++)
+    {
+        for (size_t i = first; i < num_pages; i += stride)
+        {
+            offsets[page++] = offset_start + i * padding;
+        }
+    }
+    
+    for (size_t i = 0; i < (num_pages >> 1) && order == ORDER_REVERSE; i++)
+    {
+        const off_t offset         = offsets[i];
+        offsets[i]                 = offsets[num_pages - 1 - i];
+        offsets[num_pages - 1 - i] = offset;
+    }
+    
+    for (size_t i = num_pages; i > 1 && order == ORDER_RANDOM; i--)
+    {
+        const size_t j      = rand_r(&seed) % i;
+        const off_t  offset = offsets[i - 1];
+        offsets[i - 1]      = offsets[j];
+        offsets[j]          = offset;
+    }
+}
+
+/**
+ * Helper method that triggers the page-faults of the assigned pages in order,
+ * optionally timing each fault individually. The minor and major faults are
+ * obtained from the resource usage of the calling thread. With overlapping
+ * pages, most accesses hit a page already mapped by another thread, so that
+ * only the accesses that raised a fault on the thread are recorded.
+ */
+void launchFaults(pf_thread_t *pfthread)
+{
+    struct rusage usage[2] = { 0 };
+    uint64_t      pf_start = 0;
+    uint64_t      pf_end   = 0;
+    long          num_flt  = 0;
+    
+    pthread_barrier_wait(pfthread->barrier);
+    getrusage(RUSAGE_THREAD, &usage[0]);
+    num_flt = usage[0].ru_minflt + usage[0].ru_majflt;
+    
+    for (size_t page = 0; page < pfthread->num_pages; page++)
+    {
+        const off_t offset = pfthread->offsets[page];
+        
+        for (int alloc = 0; alloc < pfthread->num_alloc; alloc++)
+        {
+            if (pfthread->hist != NULL)
+            {
+                pf_start = histGetTime();
+            }
+            
+            if (pfthread->is_write)
+            {
+                pfthread->baseptr[alloc][offset] = 21;
+            }
+            else
+            {
+                pfthread->checksum += pfthread->baseptr[alloc][offset];
+            }
+            
+            if (pfthread->hist != NULL)
+            {
+                pf_end = histGetTime();
+                
+                // The counters are read after the access is timed
+                if (pfthread->is_overlap)
+                {
+                    const long num_flt_prev = num_flt;
+                    
+                    getrusage(RUSAGE_THREAD, &usage[1]);
+                    num_flt = usage[1].ru_minflt + usage[1].ru_majflt;
+                    
+                    if (num_flt == num_flt_prev)
+                    {
+                        continue;
+                    }
+                }
+                
+                histRecord(pfthread->hist, (pf_end - pf_start));
+            }
+        }
+    }
+    
+    getrusage(RUSAGE_THREAD, &usage[1]);
+    pfthread->num_minflt = usage[1].ru_minflt - usage[0].ru_minflt;
+    pfthread->num_majflt = usage[1].ru_majflt - usage[0].ru_majflt;
+}
+
+/**
+ * Thread routine that launches the page-fault test on the secondary threads.
+ */
+void *launchThread(void *arg)
+{
+    launchFaults((pf_thread_t *)arg);
+    
+    return NULL;
+}
+
 int main (int argc, char *argv[]) __CHK_FN__
 {
     // Input parameters for the benchmark
@@ -33,9 +193,23 @@ int main (int argc, char *argv[]) __CHK_FN__
     int          num_procs          = 0;
     char         **baseptr          = NULL;
     int          fd                 = -1;
+    int          *fd_uffd           = NULL;
+    uffd_t       **uffd             = NULL;
     char         filename[PATH_MAX] = { 0 };
     timespec_t   start              = { 0 };
     timespec_t   stop               = { 0 };
+    uint32_t     num_threads        = 1;
+    int          is_overlap         = FALSE;
+    int          map_variant        = 0;
+    int          mode               = MODE_WRITE;
+    int          order              = ORDER_FORWARD;
+    size_t       stride             = 0;
+    size_t       seg_first          = 0;
+    int          is_file            = FALSE;
+    hist_t       *hist              = NULL;
+    pf_thread_t  *pfthread          = NULL;
+    pthread_t    *threads           = NULL;
+    pthread_barrier_t barrier;
     
     // Check if the number of parameters match the expected
     if (argc < 5 || argc > 6)
@@ -60,87 +234,253 @@ int main (int argc, char *argv[]) __CHK_FN__
         sscanf(argv[5], "%zu", &seg_size);
     }
     
-    // Create the temp. folder according to the settings
-    if (rank == 0 && impl_type == IMPL_UMMAP)
+    num_threads = getEnvSize(ENV_THREADS, 1);
+    is_overlap  = getEnvSize(ENV_OVERLAP, FALSE);
+    map_variant = (impl_type == IMPL_MEM || impl_type == IMPL_MMAP) ?
+                  getEnvSize(ENV_MAPVAR, 0) : 0;
+    mode        = getEnvSize(ENV_MODE, MODE_WRITE);
+    order       = getEnvSize(ENV_ORDER, ORDER_FORWARD);
+    stride      = getEnvSize(ENV_STRIDE, 16);
+    
+    // The read modes fault on the pages of the backing file
+    if (mode != MODE_WRITE && impl_type == IMPL_MEM)
     {
-        CHKPRINT(createDir(argv[4]));
+        fprintf(stderr, "Error: The read modes require a backing file (i.e., "
+                        "not IMPL_MEM)!\n");
+        CHKPRINT(MPI_Abort(MPI_COMM_WORLD, EINVAL));
     }
     
-    // Force all processes to wait before allocating
-    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+    // The pagers are always backed by a file, while mmap is only backed by
+    // a file on the read modes (i.e., to compare with the kernel read-ahead)
+    is_file     = (impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD ||
+                   (impl_type == IMPL_MMAP && mode != MODE_WRITE));
     
-    // Allocate the corresponding resources
-    baseptr      = (char **)malloc(sizeof(char *) * num_alloc);
-    alloc_size_s = (alloc_size / (size_t)num_alloc);
+    // Sweep the segment size from a single page, if requested
+    seg_first   = (getEnvSize(ENV_SWEEP, FALSE) &&
+                   (impl_type == IMPL_UMMAP || impl_type == IMPL_UFFD)) ?
+                  padding : seg_size;
     
-    for (int alloc = 0; alloc < num_alloc; alloc++)
+    // Create the temp. folder according to the settings
+    if (rank == 0 && is_file)
     {
-        if (impl_type == IMPL_UMMAP)
-        {
-            sprintf(filename, "%s/%s", argv[4], TMP_FILE);
-            CHKPRINT(openFile(filename, POSIX_FLAGS, FALSE, alloc_size_s, &fd));
-            CHKPRINT(ummap(alloc_size_s, seg_size, PROT_FULL, fd, 0, UINT_MAX,
-                           FALSE, 0, (void **)&baseptr[alloc]));
-            CHKPRINT(close(fd));
-        }
-        else
-        {
-            baseptr[alloc] = mmap(NULL, alloc_size_s, PROT_FULL, MMAP_FLAGS_M,
-                                  fd, 0);
-            CHKBPRINT((baseptr[alloc] == MAP_FAILED), errno);
-        }
+        CHKPRINT(createDir(argv[4]));
     }
     
-    // Force all processes to wait before starting the test
-    CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
-    
-    // Launch the page-fault test
-    clock_gettime(CLOCK_REALTIME, &start);
-    for (off_t offset = 0; offset < alloc_size_s; offset += padding)
+    for (size_t seg = seg_first; seg <= seg_size; seg <<= 1)
     {
+        // Allocate the per-fault histogram of each thread, if requested
+        if (getEnvSize(ENV_HIST, FALSE))
+        {
+            hist = (hist_t *)calloc(num_threads, sizeof(hist_t));
+        }
+        
+        // Force all processes to wait before allocating
+        CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+        
+        // Allocate the corresponding resources
+        baseptr      = (char **)malloc(sizeof(char *) * num_alloc);
+        alloc_size_s = (alloc_size / (size_t)num_alloc);
+        fd_uffd      = (int *)malloc(sizeof(int) * num_alloc);
+        uffd         = (uffd_t **)malloc(sizeof(uffd_t *) * num_alloc);
+        
         for (int alloc = 0; alloc < num_alloc; alloc++)
         {
-            baseptr[alloc][offset] = 21;
+            // Each allocation of each process is backed by its own file
+            if (is_file)
+            {
+                sprintf(filename, "%s/%s.%d.%d", argv[4], TMP_FILE, rank,
+                        alloc);
+                CHKPRINT(openFile(filename, POSIX_FLAGS, TRUE, alloc_size_s,
+                                  &fd));
+                
+                if (mode != MODE_WRITE)
+                {
+                    CHKPRINT(setCacheState(fd, 0, alloc_size_s,
+                                           ((mode == MODE_READ) ? CACHE_COLD :
+                                                                  CACHE_WARM)));
+                }
+            }
+            
+            if (impl_type == IMPL_UMMAP)
+            {
+                CHKPRINT(ummap(alloc_size_s, seg, PROT_FULL, fd, 0, UINT_MAX,
+                               (mode != MODE_WRITE), 0,
+                               (void **)&baseptr[alloc]));
+                CHKPRINT(close(fd));
+            }
+            else if (impl_type == IMPL_UFFD)
+            {
+                // The file remains open, as the pager reads / writes segments
+                fd_uffd[alloc] = fd;
+                CHKPRINT(uffdMap(alloc_size_s, seg, fd_uffd[alloc], 0, 0,
+                                 (mode != MODE_WRITE), UFFD_PTYPE_FIFO,
+                                 &uffd[alloc], (void **)&baseptr[alloc]));
+            }
+            else if (is_file)
+            {
+                CHKPRINT(mapMemory(alloc_size_s, PROT_FULL, MMAP_FLAGS, fd, 0,
+                                   map_variant, (void **)&baseptr[alloc]));
+                CHKPRINT(close(fd));
+            }
+            else
+            {
+                CHKPRINT(mapMemory(alloc_size_s, PROT_FULL, MMAP_FLAGS_M, -1,
+                                   0, map_variant, (void **)&baseptr[alloc]));
+            }
         }
-    }
-    clock_gettime(CLOCK_REALTIME, &stop);
-    
-    // Print the result (in order)
-    for (int drank = 0; drank < num_procs; drank++)
-    {
+        
+        // Force all processes to wait before starting the test
         CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
         
-        if (drank == rank)
+        // Split the pages among the threads (or assign all of them, if
+        // overlapped), and list them in the requested order
+        pfthread = (pf_thread_t *)calloc(num_threads, sizeof(pf_thread_t));
+        threads  = (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+        CHKPRINT(pthread_barrier_init(&barrier, NULL, num_threads));
+        
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
         {
-            double num_pf  = (double)(alloc_size / padding);
-            double elapsed = getElapsed(start, stop, TSUNIT_NSEC) / num_pf;
+            const size_t num_pages  = alloc_size_s / padding;
+            const size_t page_start = (is_overlap) ? 0 :
+                                      (num_pages * thread_id / num_threads);
+            const size_t page_end   = (is_overlap) ? num_pages :
+                                      (num_pages * (thread_id + 1) /
+                                       num_threads);
+            
+            pfthread[thread_id].baseptr   = baseptr;
+            pfthread[thread_id].num_alloc = num_alloc;
+            pfthread[thread_id].num_pages = page_end - page_start;
+            pfthread[thread_id].offsets   = (off_t *)malloc(sizeof(off_t) *
+                                                            (page_end -
+                                                             page_start));
+            pfthread[thread_id].is_write  = (mode == MODE_WRITE);
+            pfthread[thread_id].hist      = (hist != NULL) ? &hist[thread_id] :
+                                                             NULL;
+            pfthread[thread_id].barrier   = &barrier;
             
-            printf("%d;%d; %zu;%zu;%d;%d; %lf\n", rank, num_procs, alloc_size,
-                   seg_size, impl_type, num_alloc, elapsed);
+            // Only the faults of the thread are timed on overlapping pages
+            pfthread[thread_id].is_overlap = is_overlap;
+            
+            orderPages(pfthread[thread_id].offsets, (page_end - page_start),
+                       (page_start * padding), padding, order, stride,
+                       ((rank + 1) * 921 + thread_id * 7919));
+            
+            if (thread_id > 0)
+            {
+                CHKPRINT(pthread_create(&threads[thread_id], NULL,
+                                        launchThread, &pfthread[thread_id]));
+            }
         }
-    }
-    
-    // Release the resources
-    for (int alloc = 0; alloc < num_alloc; alloc++)
-    {
-        if (impl_type == IMPL_UMMAP)
+        
+        // Launch the page-fault test (the main thread acts as the first
+        // thread)
+        clock_gettime(CLOCK_REALTIME, &start);
+        launchFaults(&pfthread[0]);
+        
+        for (uint32_t thread_id = 1; thread_id < num_threads; thread_id++)
+        {
+            CHKPRINT(pthread_join(threads[thread_id], NULL));
+            
+            // Accumulate the results of the thread into the main thread
+            pfthread[0].num_minflt += pfthread[thread_id].num_minflt;
+            pfthread[0].num_majflt += pfthread[thread_id].num_majflt;
+            pfthread[0].checksum   += pfthread[thread_id].checksum;
+            
+            if (hist != NULL)
+            {
+                histMerge(&hist[0], &hist[thread_id]);
+            }
+        }
+        clock_gettime(CLOCK_REALTIME, &stop);
+        
+        CHKPRINT(pthread_barrier_destroy(&barrier));
+        
+        // Print the result (in order)
+        for (int drank = 0; drank < num_procs; drank++)
         {
-            CHKPRINT(umunmap(baseptr[alloc], FALSE));
+            CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
+            
+            if (drank == rank)
+            {
+                double num_pf  = (double)(alloc_size / padding);
+                double elapsed = getElapsed(start, stop, TSUNIT_NSEC) / num_pf;
+                
+                printf("%d;%d; %zu;%zu;%d;%d; %lf; %d;%d;%d\n", rank,
+                       num_procs, alloc_size, seg, impl_type, num_alloc,
+                       elapsed, map_variant, mode, order);
+                
+                // Print the minor / major faults of the storm, if launched,
+                // or of the read faults (i.e., the data had to be fetched)
+                if (num_threads > 1 || hist != NULL || mode != MODE_WRITE)
+                {
+                    printf("faults;%d;%u;%d; %ld;%ld\n", rank, num_threads,
+                           is_overlap, pfthread[0].num_minflt,
+                           pfthread[0].num_majflt);
+                }
+            }
         }
-        else
+        
+        // Merge the histograms of all the processes and print the percentiles
+        if (hist != NULL)
         {
-            CHKPRINT(munmap(baseptr[alloc], alloc_size_s));
+            hist_t *hist_all = (hist_t *)calloc(1, sizeof(hist_t));
+            
+            CHKPRINT(histReduce(&hist[0], hist_all, 0, MPI_COMM_WORLD));
+            
+            if (rank == 0)
+            {
+                printf("hist;fault; %lu; %lf;%lf;%lf;%lf;%lf\n",
+                       (unsigned long)hist_all->count,
+                       histPercentile(hist_all, 50.0) / 1000.0,
+                       histPercentile(hist_all, 90.0) / 1000.0,
+                       histPercentile(hist_all, 99.0) / 1000.0,
+                       histPercentile(hist_all, 99.9) / 1000.0,
+                       hist_all->max / 1000.0);
+            }
+            
+            free(hist_all);
+            free(hist);
         }
+        
+        for (uint32_t thread_id = 0; thread_id < num_threads; thread_id++)
+        {
+            free(pfthread[thread_id].offsets);
+        }
+        
+        free(threads);
+        free(pfthread);
+        
+        // Release the resources
+        for (int alloc = 0; alloc < num_alloc; alloc++)
+        {
+            if (impl_type == IMPL_UMMAP)
+            {
+                CHKPRINT(umunmap(baseptr[alloc], FALSE));
+            }
+            else if (impl_type == IMPL_UFFD)
+            {
+                CHKPRINT(uffdUnmap(uffd[alloc], FALSE));
+                CHKPRINT(close(fd_uffd[alloc]));
+            }
+            else
+            {
+                CHKPRINT(unmapMemory(baseptr[alloc], alloc_size_s,
+                                     map_variant));
+            }
+        }
+        
+        free(baseptr);
+        free(fd_uffd);
+        free(uffd);
+        hist = NULL;
     }
     
-    free(baseptr);
-    
     // Force all processes to wait before finalizing the MPI session
     CHKPRINT(MPI_Barrier(MPI_COMM_WORLD));
     
 #if !VERIFY_OUTPUT
-    // Delete the temp. folder containing the file
-    if (rank == 0 && impl_type == IMPL_UMMAP)
+    // Delete the temp. folder containing the files
+    if (rank == 0 && is_file)
     {
         CHKPRINT(deleteDir(argv[4]));
     }
@@ -151,4 +491,3 @@ int main (int argc, char *argv[]) __CHK_FN__
     
     return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
 }
-
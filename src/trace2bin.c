@@ -0,0 +1,208 @@
+#include "common.h"
+#include "util.h"
+#include "trace.h"
+
+#define TRACE2BIN_PARAMS "[input] [output] [format]"
+#define MAX_LINE         4096
+#define MAX_THINK_US     UINT16_MAX
+#define SECTOR_SIZE      512
+
+enum TraceFormat
+{
+    FORMAT_CSV = 0, // 0 << "op,offset,length[,think_us]" (op is "r" or "w")
+    FORMAT_STRACE,  // 1 << "strace -ttt -e pread64,pwrite64" output
+    FORMAT_BLKTRACE // 2 << "blkparse" output (only queued "Q" events)
+};
+
+/**
+ * Helper method that parses a line in CSV format. Returns FALSE if the line
+ * does not contain a valid record (e.g., comments).
+ */
+int parseCSV(const char *line, trace_record_t *record, double *timestamp)
+{
+    char     op[16]   = { 0 };
+    uint64_t offset   = 0;
+    uint32_t length   = 0;
+    uint32_t think_us = 0;
+    
+    if (sscanf(line, " %15[^,],%lu,%u,%u", op, &offset, &length,
+               &think_us) < 3)
+    {
+        return FALSE;
+    }
+    
+    record->offset   = offset;
+    record->length   = length;
+    record->is_write = (op[0] == 'w' || op[0] == 'W');
+    record->think_us = (think_us > MAX_THINK_US) ? MAX_THINK_US : think_us;
+    *timestamp       = -1.0;
+    
+    return (op[0] == 'r' || op[0] == 'R' || record->is_write);
+}
+
+/**
+ * Helper method that parses a line of the strace output. Only the positional
+ * system calls are considered, as they are the only ones with an offset.
+ */
+int parseStrace(const char *line, trace_record_t *record, double *timestamp)
+{
+    const char *call        = NULL;
+    const char *args        = NULL;
+    char       token[2][64] = { { 0 } };
+    uint64_t   offset       = 0;
+    uint32_t   length       = 0;
+    int        num_commas   = 0;
+    
+    if ((call = strstr(line, "pwrite64(")) != NULL)
+    {
+        record->is_write = TRUE;
+    }
+    else if ((call = strstr(line, "pread64(")) != NULL)
+    {
+        record->is_write = FALSE;
+    }
+    else
+    {
+        return FALSE;
+    }
+    
+    // The length and the offset are the last two arguments of the call
+    if ((args = strstr(call, ") = ")) == NULL)
+    {
+        return FALSE;
+    }
+    
+    while (args > call && num_commas < 2)
+    {
+        num_commas += (*(--args) == ',');
+    }
+    
+    if (sscanf(args, ", %u, %lu", &length, &offset) != 2)
+    {
+        return FALSE;
+    }
+    
+    record->offset = offset;
+    record->length = length;
+    
+    // The timestamp (-ttt) might be preceded by the PID of the caller (-f)
+    *timestamp = -1.0;
+    sscanf(line, "%63s %63s", token[0], token[1]);
+    
+    for (int i = 0; i < 2; i++)
+    {
+        if (strchr(token[i], '.') != NULL && sscanf(token[i], "%lf",
+                                                    timestamp) == 1)
+        {
+            break;
+        }
+    }
+    
+    return TRUE;
+}
+
+/**
+ * Helper method that parses a line of the blkparse output.
+ */
+int parseBlktrace(const char *line, trace_record_t *record, double *timestamp)
+{
+    char     action[8] = { 0 };
+    char     rwbs[8]   = { 0 };
+    uint64_t sector    = 0;
+    uint32_t num_sect  = 0;
+    
+    if (sscanf(line, "%*s %*d %*d %lf %*d %7s %7s %lu + %u", timestamp,
+               action, rwbs, &sector, &num_sect) != 5 || strcmp(action, "Q") ||
+        num_sect == 0)
+    {
+        return FALSE;
+    }
+    
+    record->offset   = sector   * SECTOR_SIZE;
+    record->length   = num_sect * SECTOR_SIZE;
+    record->is_write = (strchr(rwbs, 'W') != NULL);
+    
+    return (record->is_write || strchr(rwbs, 'R') != NULL);
+}
+
+int main (int argc, char *argv[]) __CHK_FN__
+{
+    int            format         = FORMAT_CSV;
+    FILE           *input         = NULL;
+    FILE           *output        = NULL;
+    char           line[MAX_LINE] = { 0 };
+    trace_header_t header         = { 0 };
+    trace_record_t record         = { 0 };
+    double         timestamp      = 0.0;
+    double         timestamp_prev = -1.0;
+    int            is_valid       = FALSE;
+    
+    // Check if the number of parameters match the expected
+    if (argc != 4)
+    {
+        fprintf(stderr, "Error: The number of parameters is incorrect!\n");
+        fprintf(stderr, "Use: %s %s\n", argv[0], TRACE2BIN_PARAMS);
+        return -1;
+    }
+    
+    sscanf(argv[3], "%d", &format);
+    
+    input  = fopen(argv[1], "r");
+    output = fopen(argv[2], "wb");
+    CHKBPRINT((input == NULL || output == NULL), errno);
+    
+    // Reserve the space of the header, which is written at the end
+    header.magic = TRACE_MAGIC;
+    CHKBPRINT((fwrite(&header, sizeof(trace_header_t), 1, output) != 1), EIO);
+    
+    while (fgets(line, MAX_LINE, input) != NULL)
+    {
+        memset(&record, 0, sizeof(trace_record_t));
+        
+        switch (format)
+        {
+            case FORMAT_STRACE:
+                is_valid = parseStrace(line, &record, &timestamp); break;
+            case FORMAT_BLKTRACE:
+                is_valid = parseBlktrace(line, &record, &timestamp); break;
+            default: // FORMAT_CSV
+                is_valid = parseCSV(line, &record, &timestamp);
+        }
+        
+        if (!is_valid || record.length == 0)
+        {
+            continue;
+        }
+        
+        // Derive the think-time from the timestamps, if available
+        if (timestamp >= 0.0 && timestamp_prev >= 0.0)
+        {
+            double think_us = (timestamp - timestamp_prev) * 1000000.0;
+            record.think_us = (think_us > MAX_THINK_US) ? MAX_THINK_US :
+                              (think_us > 0.0) ? (uint16_t)think_us : 0;
+        }
+        
+        timestamp_prev = timestamp;
+        
+        CHKBPRINT((fwrite(&record, sizeof(trace_record_t), 1, output) != 1),
+                  EIO);
+        
+        header.num_records++;
+        header.total_size += record.length;
+        header.max_length  = (record.length > header.max_length) ?
+                             record.length : header.max_length;
+    }
+    
+    // Update the header with the final summary of the trace
+    CHKPRINT(fseek(output, 0, SEEK_SET));
+    CHKBPRINT((fwrite(&header, sizeof(trace_header_t), 1, output) != 1), EIO);
+    
+    fclose(input);
+    fclose(output);
+    
+    printf("%lu;%lu;%u\n", (unsigned long)header.num_records,
+           (unsigned long)header.total_size, header.max_length);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
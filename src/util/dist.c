@@ -0,0 +1,186 @@
+#include "common.h"
+#include "dist.h"
+#include <math.h>
+
+/**
+ * Helper method that computes the generalized harmonic number of order theta.
+ */
+static double getZeta(uint64_t num_items, double theta)
+{
+    double zeta = 0.0;
+    
+    for (uint64_t i = 1; i <= num_items; i++)
+    {
+        zeta += 1.0 / pow((double)i, theta);
+    }
+    
+    return zeta;
+}
+
+/**
+ * Helper method that maps an item to another one of the same power-of-two
+ * range (i.e., given by the mask). Every step of the rounds is invertible
+ * modulo the range, so that the mapping is a bijection for any key.
+ */
+static inline uint64_t getPermuted(uint64_t item, uint64_t mask, uint64_t key)
+{
+    const int shift = (64 - __builtin_clzll(mask | 1)) >> 1;
+    
+    item = (item ^ key) & mask;
+    item = (item * __UINT64_C(0xBF58476D1CE4E5B9)) & mask;
+    item ^= item >> (shift + 1);
+    item = (item * __UINT64_C(0x94D049BB133111EB)) & mask;
+    item ^= item >> (shift + 1);
+    item = (item + (key >> 32)) & mask;
+    
+    return item;
+}
+
+/**
+ * Helper method that returns the position of the given index in a random
+ * permutation of the items. The permutation over the power-of-two range is
+ * restricted to the items by cycle-walking (i.e., less than two steps are
+ * expected), so that no state is required besides the key.
+ */
+static inline uint64_t getPermutation(uint64_t index, uint64_t num_items,
+                                      uint64_t mask, uint64_t key)
+{
+    do
+    {
+        index = getPermuted(index, mask, key);
+    } while (index >= num_items);
+    
+    return index;
+}
+
+void distInit(dist_t *dist, disttype_t type, uint64_t num_items, uint64_t seed,
+              double skew, double hot_access, double hot_data,
+              uint64_t move_period, uint64_t block_items)
+{
+    memset(dist, 0, sizeof(dist_t));
+    
+    dist->type        = type;
+    dist->num_items   = (num_items > 0) ? num_items : 1;
+    dist->state       = seed;
+    dist->perm_state  = seed;
+    dist->perm_stride = 1;
+    dist->hot_prob    = hot_access / 100.0;
+    dist->hot_items   = (uint64_t)(dist->num_items * (hot_data / 100.0));
+    dist->hot_items   = (dist->hot_items > 0) ? dist->hot_items : 1;
+    dist->move_period = (move_period > 0) ? move_period : dist->num_items;
+    dist->block_items = (type == DIST_BLOCKED && block_items > 0) ?
+                        block_items : 1;
+    dist->num_blocks  = dist->num_items / dist->block_items;
+    
+    // The permutations are built over the smallest power-of-two range
+    while ((dist->perm_mask + 1) < dist->num_blocks)
+    {
+        dist->perm_mask = (dist->perm_mask << 1) | 1;
+    }
+    
+    // Zipfian constants (Gray et al., "Quickly Generating Billion-Record
+    // Synthetic Databases"), where the exponent must be different from one
+    if (type == DIST_ZIPF)
+    {
+        dist->theta  = (skew == 1.0) ? 0.999999 : skew;
+        dist->alpha  = 1.0 / (1.0 - dist->theta);
+        dist->zeta_n = getZeta(dist->num_items, dist->theta);
+        dist->eta    = (1.0 - pow(2.0 / dist->num_items, 1.0 - dist->theta)) /
+                       (1.0 - getZeta(2, dist->theta) / dist->zeta_n);
+    }
+}
+
+void distSeed(dist_t *dist, uint64_t seed)
+{
+    dist->state    = seed;
+    dist->hot_base = 0;
+    dist->count    = 0;
+}
+
+void distRestart(dist_t *dist, uint32_t part, uint32_t num_parts)
+{
+    if (dist->type == DIST_PERMUTATION || dist->type == DIST_BLOCKED)
+    {
+        dist->perm_key    = distRandom(&dist->perm_state);
+        dist->perm_stride = (num_parts > 0) ? num_parts : 1;
+        dist->count       = part;
+    }
+}
+
+uint64_t distNext(dist_t *dist)
+{
+    uint64_t item = 0;
+    
+    switch (dist->type)
+    {
+        case DIST_ZIPF:
+        {
+            const double u  = distUniform(&dist->state);
+            const double uz = u * dist->zeta_n;
+            
+            if (uz < 1.0)
+            {
+                item = 0;
+            }
+            else if (uz < 1.0 + pow(0.5, dist->theta))
+            {
+                item = 1;
+            }
+            else
+            {
+                item = (uint64_t)(dist->num_items *
+                                  pow(dist->eta * u - dist->eta + 1.0,
+                                      dist->alpha));
+            }
+        } break;
+        
+        case DIST_HOTCOLD:
+        case DIST_HOTSPOT:
+        {
+            const uint64_t cold_items = dist->num_items - dist->hot_items;
+            
+            if (distUniform(&dist->state) < dist->hot_prob || cold_items == 0)
+            {
+                item = distRandom(&dist->state) % dist->hot_items;
+            }
+            else
+            {
+                item = dist->hot_items + distRandom(&dist->state) % cold_items;
+            }
+            
+            // The hotspot moves to the next region after each period
+            if (dist->type == DIST_HOTSPOT)
+            {
+                item = (item + dist->hot_base) % dist->num_items;
+                
+                if (++dist->count % dist->move_period == 0)
+                {
+                    dist->hot_base = (dist->hot_base + dist->hot_items) %
+                                     dist->num_items;
+                }
+            }
+        } break;
+        
+        case DIST_PERMUTATION:
+        case DIST_BLOCKED:
+        {
+            const uint64_t index = dist->count % dist->num_items;
+            const uint64_t block = index / dist->block_items;
+            
+            dist->count += dist->perm_stride;
+            
+            // The items of the partial block (if any) are the last ones of
+            // the pass, so that every position of the pass is in range
+            item = (block < dist->num_blocks) ?
+                   getPermutation(block, dist->num_blocks, dist->perm_mask,
+                                  dist->perm_key) * dist->block_items +
+                   (index % dist->block_items) : index;
+        } break;
+        
+        default: // DIST_UNIFORM
+            item = distRandom(&dist->state) % dist->num_items;
+    }
+    
+    return (item < dist->num_items) ? item : (dist->num_items - 1);
+}
+
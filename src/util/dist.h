@@ -0,0 +1,104 @@
+#ifndef _DIST_H
+#define _DIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enumerate that defines the type of access distribution over the items.
+ */
+typedef enum
+{
+    DIST_UNIFORM = 0,
+    DIST_ZIPF,
+    DIST_HOTCOLD,
+    DIST_HOTSPOT,
+    DIST_PERMUTATION, // Every item exactly once per pass, in random order
+    DIST_BLOCKED      // Blocks of consecutive items, in random order
+} disttype_t;
+
+/**
+ * Structure that contains the state of an access distribution. The state is
+ * fully initialized in advance, so that generating the next item does not
+ * require any allocation.
+ */
+typedef struct
+{
+    disttype_t type;
+    uint64_t   num_items;
+    uint64_t   state;
+    double     theta;
+    double     alpha;
+    double     zeta_n;
+    double     eta;
+    uint64_t   hot_items;
+    double     hot_prob;
+    uint64_t   hot_base;
+    uint64_t   move_period;
+    uint64_t   count;
+    uint64_t   block_items;
+    uint64_t   num_blocks;
+    uint64_t   perm_mask;
+    uint64_t   perm_key;
+    uint64_t   perm_state;
+    uint64_t   perm_stride;
+} dist_t;
+
+/**
+ * Helper method that returns the next pseudo-random number (SplitMix64).
+ */
+static inline uint64_t distRandom(uint64_t *state)
+{
+    uint64_t z = (*state += __UINT64_C(0x9E3779B97F4A7C15));
+    
+    z = (z ^ (z >> 30)) * __UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * __UINT64_C(0x94D049BB133111EB);
+    
+    return (z ^ (z >> 31));
+}
+
+/**
+ * Helper method that returns a pseudo-random number in the [0, 1) interval.
+ */
+static inline double distUniform(uint64_t *state)
+{
+    return (distRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Helper method that initializes an access distribution over a number of
+ * items. The skew is the Zipfian exponent, the hot settings define the
+ * percentage of accesses that target the percentage of hot data, and the
+ * move period defines after how many accesses the hotspot moves. The block
+ * defines the number of consecutive items of the blocked distribution.
+ */
+void distInit(dist_t *dist, disttype_t type, uint64_t num_items, uint64_t seed,
+              double skew, double hot_access, double hot_data,
+              uint64_t move_period, uint64_t block_items);
+
+/**
+ * Helper method that changes the seed of an initialized distribution.
+ */
+void distSeed(dist_t *dist, uint64_t seed);
+
+/**
+ * Helper method that starts the next pass of the permutations, where the
+ * positions are split among the parts (i.e., every N-th position from the
+ * given part). The parts of the same pass follow the same permutation, as
+ * long as each of them starts the same number of passes, so that they cover
+ * every item once. The rest of distributions keep their state.
+ */
+void distRestart(dist_t *dist, uint32_t part, uint32_t num_parts);
+
+/**
+ * Helper method that returns the next item of the distribution.
+ */
+uint64_t distNext(dist_t *dist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,63 @@
+#include "common.h"
+#include "hist.h"
+
+/**
+ * Helper method that returns the highest value that falls into a bucket.
+ */
+static uint64_t getBucketLimit(uint32_t index)
+{
+    const uint32_t shift = (index >> HIST_SUB_BITS);
+    const uint64_t sub   = (index & (HIST_SUB_COUNT - 1));
+    
+    if (shift == 0)
+    {
+        return sub;
+    }
+    
+    return ((HIST_SUB_COUNT + sub + 1) << (shift - 1)) - 1;
+}
+
+void histMerge(hist_t *hist_dst, const hist_t *hist_src)
+{
+    for (uint32_t i = 0; i < HIST_NUM_BUCKETS; i++)
+    {
+        hist_dst->buckets[i] += hist_src->buckets[i];
+    }
+    
+    hist_dst->count += hist_src->count;
+    hist_dst->max    = (hist_src->max > hist_dst->max) ? hist_src->max :
+                                                         hist_dst->max;
+}
+
+int histReduce(const hist_t *hist, hist_t *hist_all, int root, MPI_Comm comm)
+                                                                      __CHK_FN__
+{
+    CHK(MPI_Reduce(&hist->count, &hist_all->count, 1, MPI_UINT64_T, MPI_SUM,
+                   root, comm));
+    CHK(MPI_Reduce(&hist->max, &hist_all->max, 1, MPI_UINT64_T, MPI_MAX,
+                   root, comm));
+    CHK(MPI_Reduce(hist->buckets, hist_all->buckets, HIST_NUM_BUCKETS,
+                   MPI_UINT64_T, MPI_SUM, root, comm));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+uint64_t histPercentile(const hist_t *hist, double percentile)
+{
+    const uint64_t target = (uint64_t)((hist->count * percentile) / 100.0);
+    uint64_t       count  = 0;
+    
+    for (uint32_t i = 0; i < HIST_NUM_BUCKETS && hist->count > 0; i++)
+    {
+        count += hist->buckets[i];
+        
+        if (count > target)
+        {
+            const uint64_t value = getBucketLimit(i);
+            return (value < hist->max) ? value : hist->max;
+        }
+    }
+    
+    return hist->max;
+}
+
@@ -0,0 +1,91 @@
+#ifndef _HIST_H
+#define _HIST_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HIST_SUB_BITS    5
+#define HIST_SUB_COUNT   (1 << HIST_SUB_BITS)
+#define HIST_NUM_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+/**
+ * Enumerate that defines the index of each histogram in a read / write pair.
+ */
+typedef enum
+{
+    HIST_READ  = 0,
+    HIST_WRITE = 1
+} histop_t;
+
+/**
+ * Log-bucketed latency histogram (HDR-style). Each power of two is split into
+ * HIST_SUB_COUNT linear sub-buckets, which bounds the relative error of the
+ * reported values to 1 / HIST_SUB_COUNT. The buckets are fixed in size, so
+ * that recording a value never allocates memory.
+ */
+typedef struct
+{
+    uint64_t count;
+    uint64_t max;
+    uint64_t buckets[HIST_NUM_BUCKETS];
+} hist_t;
+
+/**
+ * Helper method that returns a monotonic timestamp in nanoseconds. The call
+ * is serviced by the vDSO, so it does not trigger a system call.
+ */
+static inline uint64_t histGetTime(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return ((uint64_t)ts.tv_sec * __UINT64_C(1000000000) + ts.tv_nsec);
+}
+
+/**
+ * Helper method that records a single value (e.g., latency in nanoseconds).
+ */
+static inline void histRecord(hist_t *hist, uint64_t value)
+{
+    uint32_t index = (uint32_t)value;
+    
+    if (value >= HIST_SUB_COUNT)
+    {
+        const uint32_t shift = (63 - __builtin_clzll(value)) - HIST_SUB_BITS;
+        
+        index = ((shift + 1) << HIST_SUB_BITS) +
+                (uint32_t)((value >> shift) & (HIST_SUB_COUNT - 1));
+    }
+    
+    hist->buckets[index]++;
+    hist->count++;
+    hist->max = (value > hist->max) ? value : hist->max;
+}
+
+/**
+ * Helper method that accumulates the values of a histogram into another.
+ */
+void histMerge(hist_t *hist_dst, const hist_t *hist_src);
+
+/**
+ * Helper method that merges the histograms of all the processes of the
+ * communicator into the root process.
+ */
+int histReduce(const hist_t *hist, hist_t *hist_all, int root, MPI_Comm comm);
+
+/**
+ * Helper method that returns the value at the given percentile (e.g., 99.9).
+ * The result is the upper bound of the bucket that contains the percentile.
+ */
+uint64_t histPercentile(const hist_t *hist, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
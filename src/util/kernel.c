@@ -0,0 +1,173 @@
+#include "common.h"
+#include "kernel.h"
+
+// The intrinsics are only available on x86-64 (i.e., the loops are portable)
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define KERNEL_SIMD_ENABLED 1
+#endif
+
+#define SCALAR_NOVEC __attribute__((optimize("no-tree-vectorize")))
+#define SCALAR_VEC   __attribute__((optimize("tree-vectorize")))
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#define TARGET_512   __attribute__((target("avx512f")))
+
+// Scalar expression of each kernel (i.e., also used for the peel / remainder)
+#define EXPR_COPY  (src1[i])
+#define EXPR_SCALE (scalar * src1[i])
+#define EXPR_ADD   (src1[i] + src2[i])
+#define EXPR_TRIAD (src1[i] + scalar * src2[i])
+
+// Vector expression of each kernel, given the width of the registers
+#define VEXPR_COPY(W)  _mm##W##_loadu_pd(&src1[i])
+#define VEXPR_SCALE(W) _mm##W##_mul_pd(vscalar, _mm##W##_loadu_pd(&src1[i]))
+#define VEXPR_ADD(W)   _mm##W##_add_pd(_mm##W##_loadu_pd(&src1[i]), \
+                                       _mm##W##_loadu_pd(&src2[i]))
+#define VEXPR_TRIAD(W) _mm##W##_add_pd(_mm##W##_loadu_pd(&src1[i]), \
+                       _mm##W##_mul_pd(vscalar, _mm##W##_loadu_pd(&src2[i])))
+
+/**
+ * Macro that defines a kernel with plain loops. The attribute decides if the
+ * compiler is allowed to vectorize the loop.
+ */
+#define KERNEL_LOOP(name, attr, expr)                                          \
+    static attr void name(double *restrict dst, const double *restrict src1,   \
+                          const double *restrict src2, double scalar, size_t n)\
+    {                                                                          \
+        for (size_t i = 0; i < n; i++)                                         \
+        {                                                                      \
+            dst[i] = expr;                                                     \
+        }                                                                      \
+    }
+
+/**
+ * Macro that defines a kernel with intrinsics. The first elements are peeled
+ * until the destination is aligned to the width of the registers, so that the
+ * (optionally non-temporal) stores are always aligned.
+ */
+#define KERNEL_SIMD(name, attr, W, L, store, fence, expr, vexpr)               \
+    static attr void name(double *restrict dst, const double *restrict src1,   \
+                          const double *restrict src2, double scalar, size_t n)\
+    {                                                                          \
+        const __m##W##d vscalar = _mm##L##_set1_pd(scalar);                    \
+        size_t          i       = 0;                                           \
+                                                                               \
+        (void)vscalar;                                                         \
+                                                                               \
+        for (; i < n && ((uintptr_t)&dst[i] & (sizeof(__m##W##d) - 1)); i++)   \
+        {                                                                      \
+            dst[i] = expr;                                                     \
+        }                                                                      \
+                                                                               \
+        for (; (i + sizeof(__m##W##d) / sizeof(double)) <= n;                  \
+               i += sizeof(__m##W##d) / sizeof(double))                        \
+        {                                                                      \
+            store(&dst[i], vexpr(L));                                          \
+        }                                                                      \
+                                                                               \
+        for (; i < n; i++)                                                     \
+        {                                                                      \
+            dst[i] = expr;                                                     \
+        }                                                                      \
+                                                                               \
+        fence;                                                                 \
+    }
+
+#define KERNEL_ALL(prefix, macro, ...)                                         \
+    macro(prefix##Copy,  __VA_ARGS__, EXPR_COPY,  VEXPR_COPY)                  \
+    macro(prefix##Scale, __VA_ARGS__, EXPR_SCALE, VEXPR_SCALE)                 \
+    macro(prefix##Add,   __VA_ARGS__, EXPR_ADD,   VEXPR_ADD)                   \
+    macro(prefix##Triad, __VA_ARGS__, EXPR_TRIAD, VEXPR_TRIAD)
+
+// The loop variants ignore the vector expression
+#define KERNEL_LOOP_V(name, attr, expr, vexpr) KERNEL_LOOP(name, attr, expr)
+
+KERNEL_ALL(kernelScalar,   KERNEL_LOOP_V, SCALAR_NOVEC)
+KERNEL_ALL(kernelAutovec,  KERNEL_LOOP_V, SCALAR_VEC)
+
+#ifdef KERNEL_SIMD_ENABLED
+KERNEL_ALL(kernelAVX2,     KERNEL_SIMD,   TARGET_AVX2, 256, 256,
+           _mm256_store_pd,  (void)0)
+KERNEL_ALL(kernelAVX2NT,   KERNEL_SIMD,   TARGET_AVX2, 256, 256,
+           _mm256_stream_pd, _mm_sfence())
+KERNEL_ALL(kernelAVX512,   KERNEL_SIMD,   TARGET_512,  512, 512,
+           _mm512_store_pd,  (void)0)
+KERNEL_ALL(kernelAVX512NT, KERNEL_SIMD,   TARGET_512,  512, 512,
+           _mm512_stream_pd, _mm_sfence())
+#endif
+
+/**
+ * Table that contains the kernels of each instruction set (regular stores on
+ * the first column, non-temporal stores on the second).
+ */
+static const kernelfn_t kernels[][2][KERNEL_NUM_TYPES] = {
+    [KERNEL_ISA_SCALAR]  = {
+        { kernelScalarCopy,   kernelScalarScale,   kernelScalarAdd,
+          kernelScalarTriad },
+        { kernelScalarCopy,   kernelScalarScale,   kernelScalarAdd,
+          kernelScalarTriad } },
+    [KERNEL_ISA_AUTOVEC] = {
+        { kernelAutovecCopy,  kernelAutovecScale,  kernelAutovecAdd,
+          kernelAutovecTriad },
+        { kernelAutovecCopy,  kernelAutovecScale,  kernelAutovecAdd,
+          kernelAutovecTriad } },
+#ifdef KERNEL_SIMD_ENABLED
+    [KERNEL_ISA_AVX2]    = {
+        { kernelAVX2Copy,     kernelAVX2Scale,     kernelAVX2Add,
+          kernelAVX2Triad },
+        { kernelAVX2NTCopy,   kernelAVX2NTScale,   kernelAVX2NTAdd,
+          kernelAVX2NTTriad } },
+    [KERNEL_ISA_AVX512]  = {
+        { kernelAVX512Copy,   kernelAVX512Scale,   kernelAVX512Add,
+          kernelAVX512Triad },
+        { kernelAVX512NTCopy, kernelAVX512NTScale, kernelAVX512NTAdd,
+          kernelAVX512NTTriad } }
+#endif
+};
+
+int kernelGetISA(kernelisa_t isa, kernelisa_t *isa_out) __CHK_FN__
+{
+#ifdef KERNEL_SIMD_ENABLED
+    __builtin_cpu_init();
+    
+    isa = (isa == KERNEL_ISA_AUTO || isa > KERNEL_ISA_AVX512) ?
+          KERNEL_ISA_AVX512 : isa;
+    
+    if (isa == KERNEL_ISA_AVX512 && !__builtin_cpu_supports("avx512f"))
+    {
+        isa = KERNEL_ISA_AVX2;
+    }
+    
+    if (isa == KERNEL_ISA_AVX2 && !__builtin_cpu_supports("avx2"))
+    {
+        isa = KERNEL_ISA_AUTOVEC;
+    }
+#else
+    // The intrinsics cannot be requested on other architectures
+    CHKB((isa > KERNEL_ISA_AUTOVEC), ENOTSUP);
+    
+    isa = (isa == KERNEL_ISA_AUTO) ? KERNEL_ISA_AUTOVEC : isa;
+#endif
+    
+    *isa_out = isa;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+kernelfn_t kernelGet(kerneltype_t type, kernelisa_t isa, int is_nt)
+{
+    return kernels[isa][(is_nt != FALSE)][type];
+}
+
+size_t kernelGetBytes(kerneltype_t type)
+{
+    return ((type <= KERNEL_SCALE) ? 2 : 3) * sizeof(double);
+}
+
+const char *kernelGetName(kerneltype_t type)
+{
+    const char *names[KERNEL_NUM_TYPES] = { "copy", "scale", "add", "triad" };
+    
+    return names[type];
+}
+
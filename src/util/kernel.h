@@ -0,0 +1,72 @@
+#ifndef _KERNEL_H
+#define _KERNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KERNEL_SCALAR 3.0
+
+/**
+ * Enumerate that defines the STREAM kernels, in the order they are launched.
+ */
+typedef enum
+{
+    KERNEL_COPY = 0, // c = a
+    KERNEL_SCALE,    // b = scalar * c
+    KERNEL_ADD,      // c = a + b
+    KERNEL_TRIAD,    // a = b + scalar * c
+    KERNEL_NUM_TYPES
+} kerneltype_t;
+
+/**
+ * Enumerate that defines the instruction set used by the kernels.
+ */
+typedef enum
+{
+    KERNEL_ISA_AUTO = 0, // Best instruction set supported by the CPU
+    KERNEL_ISA_SCALAR,   // Scalar loops (no vectorization)
+    KERNEL_ISA_AUTOVEC,  // Loops vectorized by the compiler (baseline ISA)
+    KERNEL_ISA_AVX2,     // AVX2 intrinsics
+    KERNEL_ISA_AVX512    // AVX-512 intrinsics
+} kernelisa_t;
+
+/**
+ * Kernel that writes the result of the operation over the sources into the
+ * destination (e.g., "dst[i] = src1[i] + scalar * src2[i]" on triad). The
+ * sources that are not required by the kernel are ignored.
+ */
+typedef void (*kernelfn_t)(double *dst, const double *src1, const double *src2,
+                           double scalar, size_t n);
+
+/**
+ * Helper method that resolves the instruction set to use. If the requested
+ * instruction set is not supported by the CPU, the best supported one below
+ * it is returned instead. The intrinsics are only available on x86-64 (i.e.,
+ * ENOTSUP if requested on other architectures).
+ */
+int kernelGetISA(kernelisa_t isa, kernelisa_t *isa_out);
+
+/**
+ * Helper method that returns the kernel for the given type and instruction
+ * set (which must have been resolved). The non-temporal variants bypass the
+ * cache on the stores, and are only available with intrinsics.
+ */
+kernelfn_t kernelGet(kerneltype_t type, kernelisa_t isa, int is_nt);
+
+/**
+ * Helper method that returns the number of bytes moved per element.
+ */
+size_t kernelGetBytes(kerneltype_t type);
+
+/**
+ * Helper method that returns the name of the kernel (e.g., "triad").
+ */
+const char *kernelGetName(kerneltype_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
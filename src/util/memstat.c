@@ -0,0 +1,294 @@
+#include "common.h"
+#include "memstat.h"
+
+#define MEMSTAT_INIT_SAMPLES 1024
+#define MEMSTAT_ROLLUP       "/proc/self/smaps_rollup"
+#define MEMSTAT_MEMINFO      "/proc/meminfo"
+
+/**
+ * Name of each figure of a sample (e.g., for the records).
+ */
+static const char *memstat_names[MEMSTAT_NUM_FIELDS] = {
+    "rss", "pss", "anon", "file", "dirty", "cached"
+};
+
+/**
+ * Helper method that reads the given fields (in kB) of a file with the format
+ * of /proc/meminfo, in a single pass (i.e., the rollup walks every mapping of
+ * the process on each read).
+ */
+static void readFields(const char *filename, const char **fields,
+                       uint64_t *values, int num_fields)
+{
+    FILE          *file = fopen(filename, "r");
+    char          line[256];
+    char          name[64];
+    unsigned long value = 0;
+    
+    memset(values, 0, sizeof(uint64_t) * num_fields);
+    
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "%63[^:]: %lu kB", name, &value) != 2)
+        {
+            continue;
+        }
+        
+        for (int i = 0; i < num_fields; i++)
+        {
+            if (!strcmp(name, fields[i]))
+            {
+                values[i] = (uint64_t)value << 10;
+            }
+        }
+    }
+    
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+}
+
+/**
+ * Helper method that records a periodic sample. The buffer is only accessed
+ * by the sampler thread while it is active.
+ */
+static int recordSample(memstat_t *memstat) __CHK_FN__
+{
+    if (memstat->num_samples == memstat->max_samples)
+    {
+        const uint32_t max_samples = (memstat->max_samples > 0) ?
+                                     (memstat->max_samples << 1) :
+                                     MEMSTAT_INIT_SAMPLES;
+        memsample_t    *samples    = (memsample_t *)realloc(memstat->samples,
+                                            sizeof(memsample_t) * max_samples);
+        
+        // The previous buffer is kept on failure (i.e., for memstatFree)
+        CHKB((samples == NULL), ENOMEM);
+        
+        memstat->samples     = samples;
+        memstat->max_samples = max_samples;
+    }
+    
+    memstatRead(&memstat->samples[memstat->num_samples++]);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that records a sample at the end of each interval. The
+ * intervals are absolute, so that the time to record does not drift.
+ */
+static void *launchMemstat(void *arg)
+{
+    memstat_t       *memstat = (memstat_t *)arg;
+    struct timespec next     = { 0 };
+    
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    
+    while (__atomic_load_n(&memstat->is_active, __ATOMIC_ACQUIRE))
+    {
+        next.tv_nsec += (long)memstat->interval_ms * 1000000;
+        next.tv_sec  += next.tv_nsec / 1000000000;
+        next.tv_nsec  = next.tv_nsec % 1000000000;
+        
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+                               NULL) == EINTR);
+        
+        if (recordSample(memstat))
+        {
+            break;
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * Helper method that prints a sample in MB.
+ */
+static void printSample(const char *prefix, const char *name,
+                        const memsample_t *sample)
+{
+    const uint64_t *value = sample->value;
+    
+    printf("mem;%s;%s; %lf;%lf;%lf;%lf;%lf;%lf\n", prefix, name,
+           value[MEMSTAT_RSS] / 1048576.0, value[MEMSTAT_PSS] / 1048576.0,
+           value[MEMSTAT_ANON] / 1048576.0, value[MEMSTAT_FILE] / 1048576.0,
+           value[MEMSTAT_DIRTY] / 1048576.0,
+           value[MEMSTAT_CACHED] / 1048576.0);
+}
+
+const char *memstatGetName(memfield_t field)
+{
+    return memstat_names[field];
+}
+
+void memstatRead(memsample_t *sample)
+{
+    const char *rollup[5]  = { "Rss", "Pss", "Anonymous", "Shared_Dirty",
+                               "Private_Dirty" };
+    const char *meminfo[1] = { "Cached" };
+    uint64_t   value[5];
+    uint64_t   cached;
+    
+    readFields(MEMSTAT_ROLLUP,  rollup,  value,   5);
+    readFields(MEMSTAT_MEMINFO, meminfo, &cached, 1);
+    
+    sample->value[MEMSTAT_RSS]    = value[0];
+    sample->value[MEMSTAT_PSS]    = value[1];
+    sample->value[MEMSTAT_ANON]   = value[2];
+    sample->value[MEMSTAT_FILE]   = (value[0] > value[2]) ?
+                                    (value[0] - value[2]) : 0;
+    sample->value[MEMSTAT_DIRTY]  = value[3] + value[4];
+    sample->value[MEMSTAT_CACHED] = cached;
+}
+
+int memstatStart(memstat_t *memstat, uint32_t interval_ms) __CHK_FN__
+{
+    memset(memstat, 0, sizeof(memstat_t));
+    
+    memstat->interval_ms = interval_ms;
+    memstat->is_active   = (interval_ms > 0);
+    
+    if (memstat->is_active)
+    {
+        CHK(pthread_create(&memstat->thread, NULL, launchMemstat, memstat));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void memstatPhase(memstat_t *memstat, const char *name)
+{
+    if (memstat->num_phases < MEMSTAT_MAX_PHASES)
+    {
+        memstat->phase_name[memstat->num_phases] = name;
+        memstatRead(&memstat->phase[memstat->num_phases++]);
+    }
+}
+
+int memstatStop(memstat_t *memstat) __CHK_FN__
+{
+    if (memstat->is_active)
+    {
+        __atomic_store_n(&memstat->is_active, FALSE, __ATOMIC_RELEASE);
+        CHK(pthread_join(memstat->thread, NULL));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int memstatPrint(const memstat_t *memstat, memsample_t *total_all, int root,
+                 MPI_Comm comm) __CHK_FN__
+{
+    const uint32_t num_phases = memstat->num_phases;
+    const uint32_t first      = memstat->num_samples >> 1;
+    const int      count      = (num_phases + 2) * MEMSTAT_NUM_FIELDS;
+    memsample_t    *summary   = (memsample_t *)calloc((num_phases + 2),
+                                                      sizeof(memsample_t));
+    memsample_t    *sum_all   = (memsample_t *)calloc((num_phases + 2),
+                                                      sizeof(memsample_t));
+    memsample_t    *max_all   = (memsample_t *)calloc((num_phases + 2),
+                                                      sizeof(memsample_t));
+    memsample_t    *peak      = &summary[num_phases];
+    memsample_t    *steady    = &summary[num_phases + 1];
+    int            rank       = 0;
+    int            num_procs  = 0;
+    
+    CHK(MPI_Comm_rank(comm, &rank));
+    CHK(MPI_Comm_size(comm, &num_procs));
+    
+    memcpy(summary, memstat->phase, sizeof(memsample_t) * num_phases);
+    
+    // The peak covers both the phase boundaries and the periodic samples
+    for (int field = 0; field < MEMSTAT_NUM_FIELDS; field++)
+    {
+        for (uint32_t i = 0; i < num_phases; i++)
+        {
+            const uint64_t value = summary[i].value[field];
+            
+            peak->value[field] = (value > peak->value[field]) ? value :
+                                 peak->value[field];
+        }
+        
+        for (uint32_t i = 0; i < memstat->num_samples; i++)
+        {
+            const uint64_t value = memstat->samples[i].value[field];
+            
+            peak->value[field]    = (value > peak->value[field]) ? value :
+                                    peak->value[field];
+            steady->value[field] += (i >= first) ? value : 0;
+        }
+        
+        if (memstat->num_samples > 0)
+        {
+            steady->value[field] /= (memstat->num_samples - first);
+        }
+        else if (num_phases > 0)
+        {
+            steady->value[field] = summary[num_phases - 1].value[field];
+        }
+    }
+    
+    // Print the footprint of each process (in order)
+    for (int drank = 0; drank < num_procs; drank++)
+    {
+        CHK(MPI_Barrier(comm));
+        
+        if (drank == rank)
+        {
+            char prefix[16];
+            
+            sprintf(prefix, "%d", rank);
+            
+            for (uint32_t i = 0; i < num_phases; i++)
+            {
+                printSample(prefix, memstat->phase_name[i], &summary[i]);
+            }
+            
+            printSample(prefix, "peak",   peak);
+            printSample(prefix, "steady", steady);
+        }
+    }
+    
+    // Accumulate the footprint of all the processes, except for the page
+    // cache, which is shared by the processes of the node. The peaks of the
+    // processes are not aligned in time (i.e., their sum is an upper bound of
+    // the concurrent peak)
+    CHK(MPI_Reduce(summary, sum_all, count, MPI_UINT64_T, MPI_SUM, root,
+                   comm));
+    CHK(MPI_Reduce(summary, max_all, count, MPI_UINT64_T, MPI_MAX, root,
+                   comm));
+    
+    for (uint32_t i = 0; i < (num_phases + 2) && rank == root; i++)
+    {
+        sum_all[i].value[MEMSTAT_CACHED] = max_all[i].value[MEMSTAT_CACHED];
+        
+        printSample("all", ((i < num_phases) ? memstat->phase_name[i] :
+                            (i == num_phases) ? "peak_sum" : "steady"),
+                    &sum_all[i]);
+    }
+    
+    if (rank == root)
+    {
+        total_all[0] = sum_all[num_phases];
+        total_all[1] = sum_all[num_phases + 1];
+    }
+    
+    free(summary);
+    free(sum_all);
+    free(max_all);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void memstatFree(memstat_t *memstat)
+{
+    free(memstat->samples);
+    
+    memstat->samples     = NULL;
+    memstat->num_samples = 0;
+    memstat->max_samples = 0;
+}
+
@@ -0,0 +1,104 @@
+#ifndef _MEMSTAT_H
+#define _MEMSTAT_H
+
+#include <mpi.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEMSTAT_MAX_PHASES 8
+
+/**
+ * Enumerate that defines the index of each figure in a sample. The figures
+ * of the process come from /proc/self/smaps_rollup, while the page cache is
+ * the usage of the whole node (i.e., the "Cached" field of /proc/meminfo).
+ */
+typedef enum
+{
+    MEMSTAT_RSS = 0,
+    MEMSTAT_PSS,
+    MEMSTAT_ANON,
+    MEMSTAT_FILE,
+    MEMSTAT_DIRTY,
+    MEMSTAT_CACHED,
+    MEMSTAT_NUM_FIELDS
+} memfield_t;
+
+/**
+ * Structure that contains a snapshot of the memory footprint, in bytes.
+ */
+typedef struct
+{
+    uint64_t value[MEMSTAT_NUM_FIELDS];
+} memsample_t;
+
+/**
+ * Structure that represents the footprint sampler of the process. The
+ * samples at the phase boundaries are recorded by the calling thread, while
+ * the periodic samples (if any) are recorded by a separate thread.
+ */
+typedef struct
+{
+    pthread_t   thread;
+    uint32_t    interval_ms;
+    int         is_active;
+    memsample_t *samples;
+    uint32_t    num_samples;
+    uint32_t    max_samples;
+    memsample_t phase[MEMSTAT_MAX_PHASES];
+    const char  *phase_name[MEMSTAT_MAX_PHASES];
+    uint32_t    num_phases;
+} memstat_t;
+
+/**
+ * Helper method that returns the name of the given figure.
+ */
+const char *memstatGetName(memfield_t field);
+
+/**
+ * Helper method that reads the current footprint of the calling process.
+ */
+void memstatRead(memsample_t *sample);
+
+/**
+ * Helper method that launches the sampler, which records the footprint every
+ * interval (in milliseconds). No thread is launched with a zero interval
+ * (i.e., only the phase boundaries are recorded).
+ */
+int memstatStart(memstat_t *memstat, uint32_t interval_ms);
+
+/**
+ * Helper method that records the footprint at the end of the given phase.
+ */
+void memstatPhase(memstat_t *memstat, const char *name);
+
+/**
+ * Helper method that stops the sampler thread, if launched.
+ */
+int memstatStop(memstat_t *memstat);
+
+/**
+ * Helper method that prints the footprint of each phase, the peak and the
+ * steady state (i.e., the average of the second half of the periodic
+ * samples, or the last phase without them) of the process, in order. The
+ * figures of all the processes of the communicator are also accumulated
+ * into the root process (i.e., the page cache of the node is the maximum),
+ * and the sum of the peaks and the steady state of the total are returned
+ * in total_all.
+ */
+int memstatPrint(const memstat_t *memstat, memsample_t *total_all, int root,
+                 MPI_Comm comm);
+
+/**
+ * Helper method that releases the samples.
+ */
+void memstatFree(memstat_t *memstat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
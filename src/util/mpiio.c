@@ -0,0 +1,186 @@
+#include "common.h"
+#include "mpiio.h"
+#include "util.h"
+
+/**
+ * Helper method that converts the list of hints into an MPI_Info object.
+ */
+static int mpiioParseHints(const char *hints, MPI_Info *info) __CHK_FN__
+{
+    char *hint_str = strdup(hints);
+    char *saveptr  = NULL;
+    
+    CHK(MPI_Info_create(info));
+    
+    for (char *token = strtok_r(hint_str, ",", &saveptr); token != NULL;
+         token = strtok_r(NULL, ",", &saveptr))
+    {
+        char *value = strchr(token, '=');
+        
+        CHKB((value == NULL), EINVAL);
+        *(value++) = '\0';
+        
+        CHK(MPI_Info_set(*info, token, value));
+    }
+    
+    free(hint_str);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mpiioOpen(mpiio_t *mpiio, const char *filename, int amode, size_t size,
+              mpiiomode_t mode, const char *hints, uint32_t depth,
+              size_t buffer_size) __CHK_FN__
+{
+    const MPI_Comm comm       = (mode == MPIIO_PRIVATE) ? MPI_COMM_SELF :
+                                                          MPI_COMM_WORLD;
+    MPI_Offset     region     = size;
+    MPI_Offset     total_size = size;
+    MPI_Info       info       = MPI_INFO_NULL;
+    int            rank       = 0;
+    
+    memset(mpiio, 0, sizeof(mpiio_t));
+    
+    mpiio->mode        = mode;
+    mpiio->depth       = (depth > 0) ? depth : 1;
+    mpiio->buffer_size = buffer_size;
+    
+    if (hints != NULL && *hints != '\0')
+    {
+        CHK(mpiioParseHints(hints, &info));
+    }
+    
+    CHK(MPI_File_open(comm, filename, amode, info, &mpiio->file));
+    
+    // Place the region of each process after the regions of the lower ranks
+    if (mode != MPIIO_PRIVATE)
+    {
+        CHK(MPI_Exscan(&region, &mpiio->disp, 1, MPI_OFFSET, MPI_SUM, comm));
+        CHK(MPI_Allreduce(&region, &total_size, 1, MPI_OFFSET, MPI_SUM,
+                          comm));
+        
+        // The result of the scan is undefined on the first process
+        CHK(MPI_Comm_rank(comm, &rank));
+        mpiio->disp = (rank > 0) ? mpiio->disp : 0;
+    }
+    
+    CHK(MPI_File_preallocate(mpiio->file, total_size));
+    
+    if (mode != MPIIO_PRIVATE)
+    {
+        CHK(MPI_File_set_view(mpiio->file, mpiio->disp, MPI_BYTE, MPI_BYTE,
+                              "native", info));
+    }
+    
+    if (mode == MPIIO_NONBLOCKING)
+    {
+        mpiio->requests = (MPI_Request *)malloc(sizeof(MPI_Request) *
+                                                mpiio->depth);
+        mpiio->buffers  = (char *)allocBuffer(buffer_size * mpiio->depth);
+        CHKB((mpiio->requests == NULL || mpiio->buffers == NULL), ENOMEM);
+        
+        for (uint32_t slot = 0; slot < mpiio->depth; slot++)
+        {
+            mpiio->requests[slot] = MPI_REQUEST_NULL;
+        }
+    }
+    
+    if (info != MPI_INFO_NULL)
+    {
+        CHK(MPI_Info_free(&info));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mpiioSubmit(mpiio_t *mpiio, off_t offset, void *buffer, size_t length,
+                int is_write) __CHK_FN__
+{
+    switch (mpiio->mode)
+    {
+        case MPIIO_COLLECTIVE:
+        {
+            if (is_write)
+            {
+                CHK(MPI_File_write_at_all(mpiio->file, offset, buffer, length,
+                                          MPI_BYTE, MPI_STATUS_IGNORE));
+            }
+            else
+            {
+                CHK(MPI_File_read_at_all(mpiio->file, offset, buffer, length,
+                                         MPI_BYTE, MPI_STATUS_IGNORE));
+            }
+        } break;
+        
+        case MPIIO_NONBLOCKING:
+        {
+            const uint32_t slot    = mpiio->next++ % mpiio->depth;
+            MPI_Request    *request = &mpiio->requests[slot];
+            char           *staging = &mpiio->buffers[slot *
+                                                      mpiio->buffer_size];
+            
+            CHKB((length > mpiio->buffer_size), EINVAL);
+            
+            // Reuse the staging buffer of the oldest pending operation
+            CHK(MPI_Wait(request, MPI_STATUS_IGNORE));
+            
+            if (is_write)
+            {
+                memcpy(staging, buffer, length);
+                CHK(MPI_File_iwrite_at_all(mpiio->file, offset, staging,
+                                           length, MPI_BYTE, request));
+            }
+            else
+            {
+                CHK(MPI_File_iread_at_all(mpiio->file, offset, staging,
+                                          length, MPI_BYTE, request));
+            }
+        } break;
+        
+        default: // MPIIO_PRIVATE + MPIIO_SHARED
+        {
+            if (is_write)
+            {
+                CHK(MPI_File_write_at(mpiio->file, offset, buffer, length,
+                                      MPI_BYTE, MPI_STATUS_IGNORE));
+            }
+            else
+            {
+                CHK(MPI_File_read_at(mpiio->file, offset, buffer, length,
+                                     MPI_BYTE, MPI_STATUS_IGNORE));
+            }
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mpiioDrain(mpiio_t *mpiio) __CHK_FN__
+{
+    if (mpiio->mode == MPIIO_NONBLOCKING)
+    {
+        CHK(MPI_Waitall(mpiio->depth, mpiio->requests, MPI_STATUSES_IGNORE));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mpiioSync(mpiio_t *mpiio) __CHK_FN__
+{
+    CHK(mpiioDrain(mpiio));
+    CHK(MPI_File_sync(mpiio->file));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mpiioClose(mpiio_t *mpiio) __CHK_FN__
+{
+    CHK(mpiioDrain(mpiio));
+    CHK(MPI_File_close(&mpiio->file));
+    
+    free(mpiio->requests);
+    free(mpiio->buffers);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,79 @@
+#ifndef _MPIIO_H
+#define _MPIIO_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enumerate that defines how the processes access the file.
+ */
+typedef enum
+{
+    MPIIO_PRIVATE = 0, // One file per process, independent operations
+    MPIIO_SHARED,      // Shared file with views, independent operations
+    MPIIO_COLLECTIVE,  // Shared file with views, collective operations
+    MPIIO_NONBLOCKING  // Shared file with views, non-blocking collectives
+} mpiiomode_t;
+
+/**
+ * Structure that represents a file opened with MPI-IO. On the shared modes,
+ * the region of each process is described by a file view (i.e., the offsets
+ * are relative to the region), and the non-blocking mode keeps a set of
+ * staging buffers (i.e., one buffer for each operation that can be pending).
+ */
+typedef struct
+{
+    MPI_File    file;
+    mpiiomode_t mode;
+    MPI_Offset  disp;
+    uint32_t    depth;
+    uint32_t    next;
+    MPI_Request *requests;
+    char        *buffers;
+    size_t      buffer_size;
+} mpiio_t;
+
+/**
+ * Helper method that opens the file and preallocates the region of the
+ * process. The hints are given as a list of "key=value" pairs separated by
+ * commas (e.g., "romio_cb_write=enable,cb_buffer_size=16777216"). On the
+ * shared modes, the call is collective over MPI_COMM_WORLD.
+ */
+int mpiioOpen(mpiio_t *mpiio, const char *filename, int amode, size_t size,
+              mpiiomode_t mode, const char *hints, uint32_t depth,
+              size_t buffer_size);
+
+/**
+ * Helper method that reads / writes the buffer at the given offset of the
+ * region. On the collective modes, every process must issue the same number
+ * of operations. The non-blocking mode only waits once all the staging
+ * buffers are pending.
+ */
+int mpiioSubmit(mpiio_t *mpiio, off_t offset, void *buffer, size_t length,
+                int is_write);
+
+/**
+ * Helper method that waits for the pending operations to complete.
+ */
+int mpiioDrain(mpiio_t *mpiio);
+
+/**
+ * Helper method that drains the pending operations and synchronizes the
+ * file with storage.
+ */
+int mpiioSync(mpiio_t *mpiio);
+
+/**
+ * Helper method that closes the file and releases the staging buffers.
+ */
+int mpiioClose(mpiio_t *mpiio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
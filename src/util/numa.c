@@ -0,0 +1,278 @@
+#include "common.h"
+#include "numa.h"
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+#define NUMA_SYSFS "/sys/devices/system/node"
+
+/**
+ * Helper method that parses a list of ranges (e.g., "0-3,8-11") from the
+ * given file into the set. A missing file results in an empty set.
+ */
+static void readList(const char *filename, cpu_set_t *set)
+{
+    char buffer[4096] = { 0 };
+    char *saveptr     = NULL;
+    FILE *file        = fopen(filename, "r");
+    
+    CPU_ZERO(set);
+    
+    if (file != NULL)
+    {
+        if (fgets(buffer, sizeof(buffer), file) == NULL)
+        {
+            buffer[0] = '\0';
+        }
+        
+        fclose(file);
+    }
+    
+    for (char *token = strtok_r(buffer, ",\n", &saveptr); token != NULL;
+         token = strtok_r(NULL, ",\n", &saveptr))
+    {
+        int first = 0;
+        int last  = 0;
+        
+        if (sscanf(token, "%d-%d", &first, &last) < 2)
+        {
+            last = first;
+        }
+        
+        for (int i = first; i <= last && i < CPU_SETSIZE; i++)
+        {
+            CPU_SET(i, set);
+        }
+    }
+}
+
+/**
+ * Helper method that returns the n-th CPU of the set.
+ */
+static int getCPU(const cpu_set_t *set, uint32_t index)
+{
+    int cpu = 0;
+    
+    for (; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, set) && index-- == 0)
+        {
+            break;
+        }
+    }
+    
+    return cpu;
+}
+
+/**
+ * Helper method that returns the memory policy (i.e., mode and node mask)
+ * that corresponds to the placement.
+ */
+static int getPolicy(const numa_t *numa, unsigned long *mask)
+{
+    const size_t word_bits = 8 * sizeof(unsigned long);
+    
+    memset(mask, 0, sizeof(unsigned long) * NUMA_MASK_WORDS);
+    
+    if (numa->policy == NUMA_POLICY_INTERLEAVE)
+    {
+        memcpy(mask, numa->mem_mask, sizeof(numa->mem_mask));
+        return MPOL_INTERLEAVE;
+    }
+    
+    mask[numa->mem_node / word_bits] |= 1UL << (numa->mem_node % word_bits);
+    
+    return MPOL_BIND;
+}
+
+int numaInit(numa_t *numa, numapolicy_t policy, uint32_t local_rank,
+             uint32_t num_threads) __CHK_FN__
+{
+    const size_t word_bits     = 8 * sizeof(unsigned long);
+    int          cpu_node[NUMA_MAX_NODES];
+    int          num_cpu_nodes = 0;
+    char         filename[PATH_MAX];
+    cpu_set_t    nodes;
+    cpu_set_t    nodes_mem;
+    
+    memset(numa, 0, sizeof(numa_t));
+    numa->policy = policy;
+    
+    readList(NUMA_SYSFS "/has_cpu",    &nodes);
+    readList(NUMA_SYSFS "/has_memory", &nodes_mem);
+    
+    for (int node = 0; node < NUMA_MAX_NODES; node++)
+    {
+        if (CPU_ISSET(node, &nodes))
+        {
+            cpu_node[num_cpu_nodes++] = node;
+        }
+        
+        if (CPU_ISSET(node, &nodes_mem))
+        {
+            numa->mem_mask[node / word_bits] |= 1UL << (node % word_bits);
+            numa->num_nodes++;
+        }
+    }
+    
+    // Without the topology (e.g., no sysfs), assume a single node
+    if (num_cpu_nodes == 0 || numa->num_nodes == 0)
+    {
+        cpu_node[num_cpu_nodes++] = 0;
+        numa->mem_mask[0]         = 1UL;
+        numa->num_nodes           = 1;
+    }
+    
+    if (policy == NUMA_POLICY_NONE)
+    {
+        numaGetCPU(NULL, &numa->cpu_node);
+        numa->mem_node = numa->cpu_node;
+    }
+    else
+    {
+        numa->cpu_node  = cpu_node[local_rank % num_cpu_nodes];
+        numa->mem_node  = numa->cpu_node;
+        numa->first_cpu = (local_rank / num_cpu_nodes) * num_threads;
+        
+        sprintf(filename, NUMA_SYSFS "/node%d/cpulist", numa->cpu_node);
+        readList(filename, &numa->cpus);
+        
+        if (CPU_COUNT(&numa->cpus) == 0)
+        {
+            CHKB((sched_getaffinity(0, sizeof(cpu_set_t), &numa->cpus) < 0),
+                 errno);
+        }
+        
+        numa->num_cpus = CPU_COUNT(&numa->cpus);
+    }
+    
+    // The remote node is the next node with memory (i.e., if any)
+    if (policy == NUMA_POLICY_REMOTE)
+    {
+        for (int i = 1; i < NUMA_MAX_NODES; i++)
+        {
+            const int node = (numa->cpu_node + i) % NUMA_MAX_NODES;
+            
+            if (numa->mem_mask[node / word_bits] &
+                (1UL << (node % word_bits)))
+            {
+                numa->mem_node = node;
+                break;
+            }
+        }
+    }
+    else if (policy == NUMA_POLICY_INTERLEAVE)
+    {
+        numa->mem_node = -1;
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int numaSetThread(const numa_t *numa, uint32_t thread_id) __CHK_FN__
+{
+    unsigned long mask[NUMA_MASK_WORDS];
+    cpu_set_t     cpu;
+    
+    if (numa->policy != NUMA_POLICY_NONE)
+    {
+        CPU_ZERO(&cpu);
+        CPU_SET(getCPU(&numa->cpus, ((numa->first_cpu + thread_id) %
+                                     numa->num_cpus)), &cpu);
+        CHKB((sched_setaffinity(0, sizeof(cpu_set_t), &cpu) < 0), errno);
+    }
+    
+    if (numa->policy >= NUMA_POLICY_LOCAL)
+    {
+        const int mode = getPolicy(numa, mask);
+        
+        CHKB((syscall(SYS_set_mempolicy, mode, mask,
+                      (NUMA_MAX_NODES + 1)) < 0), errno);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int numaBind(const numa_t *numa, void *addr, size_t size) __CHK_FN__
+{
+    const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t start     = (uintptr_t)addr & ~(page_size - 1);
+    const uintptr_t end       = ((uintptr_t)addr + size + page_size - 1) &
+                                ~(page_size - 1);
+    unsigned long   mask[NUMA_MASK_WORDS];
+    
+    if (numa->policy >= NUMA_POLICY_LOCAL && size > 0)
+    {
+        const int mode = getPolicy(numa, mask);
+        
+        CHKB((syscall(SYS_mbind, start, (end - start), mode, mask,
+                      (NUMA_MAX_NODES + 1), MPOL_MF_MOVE) < 0), errno);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int numaGetPlacement(const numa_t *numa, const void *addr, size_t size,
+                     numaplace_t *place) __CHK_FN__
+{
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t num_pages = size / page_size;
+    const size_t stride    = (num_pages > NUMA_SAMPLES) ?
+                             (num_pages / NUMA_SAMPLES) : 1;
+    const size_t count     = (num_pages + stride - 1) / stride;
+    void         **pages   = (void **)malloc(sizeof(void *) * (count + 1));
+    int          *status   = (int *)malloc(sizeof(int) * (count + 1));
+    
+    memset(place, 0, sizeof(numaplace_t));
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        pages[i] = (char *)addr + (i * stride * page_size);
+    }
+    
+    // Without target nodes, the call only reports the node of each page
+    if (count > 0)
+    {
+        CHKB((syscall(SYS_move_pages, 0, count, pages, NULL, status, 0) < 0),
+             errno);
+    }
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        if (status[i] < 0)
+        {
+            place->num_absent++;
+        }
+        else if (status[i] == numa->cpu_node)
+        {
+            place->num_local++;
+        }
+        else
+        {
+            place->num_remote++;
+        }
+    }
+    
+    free(pages);
+    free(status);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void numaGetCPU(int *cpu, int *node)
+{
+    unsigned int cpu_id  = 0;
+    unsigned int node_id = 0;
+    
+    syscall(SYS_getcpu, &cpu_id, &node_id, NULL);
+    
+    if (cpu != NULL)
+    {
+        *cpu = cpu_id;
+    }
+    
+    if (node != NULL)
+    {
+        *node = node_id;
+    }
+}
+
@@ -0,0 +1,93 @@
+#ifndef _NUMA_H
+#define _NUMA_H
+
+#include <sched.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUMA_MAX_NODES   64
+#define NUMA_MASK_WORDS  (NUMA_MAX_NODES / (8 * sizeof(unsigned long)))
+#define NUMA_SAMPLES     4096 // Pages sampled to report the placement
+
+/**
+ * Enumerate that defines the placement of the threads and the memory. Every
+ * policy except NUMA_POLICY_NONE pins the threads to the CPUs of the node of
+ * the process.
+ */
+typedef enum
+{
+    NUMA_POLICY_NONE = 0,  // No pinning, first-touch
+    NUMA_POLICY_PIN,       // Pinned threads, first-touch
+    NUMA_POLICY_LOCAL,     // Pinned threads, memory bound to their node
+    NUMA_POLICY_REMOTE,    // Pinned threads, memory bound to the next node
+    NUMA_POLICY_INTERLEAVE // Pinned threads, memory interleaved on all nodes
+} numapolicy_t;
+
+/**
+ * Structure that contains the placement of a process. The processes of each
+ * node are distributed round-robin over the NUMA nodes, and the threads of
+ * each process are given consecutive CPUs of its node.
+ */
+typedef struct
+{
+    numapolicy_t  policy;
+    int           num_nodes;
+    int           cpu_node;
+    int           mem_node;
+    cpu_set_t     cpus;
+    uint32_t      num_cpus;
+    uint32_t      first_cpu;
+    unsigned long mem_mask[NUMA_MASK_WORDS];
+} numa_t;
+
+/**
+ * Structure that contains the location of the sampled pages of a region.
+ */
+typedef struct
+{
+    uint32_t num_local;
+    uint32_t num_remote;
+    uint32_t num_absent;
+} numaplace_t;
+
+/**
+ * Helper method that selects the node of the process, given its index among
+ * the processes of the same node (i.e., the local rank). If the system has a
+ * single node, the remote policy falls back to the same node.
+ */
+int numaInit(numa_t *numa, numapolicy_t policy, uint32_t local_rank,
+             uint32_t num_threads);
+
+/**
+ * Helper method that pins the calling thread to its CPU and sets its memory
+ * policy, so that the buffers allocated afterwards (e.g., the staging
+ * buffers) follow the placement.
+ */
+int numaSetThread(const numa_t *numa, uint32_t thread_id);
+
+/**
+ * Helper method that binds the region to the memory node(s) of the policy,
+ * migrating the pages that are already resident.
+ */
+int numaBind(const numa_t *numa, void *addr, size_t size);
+
+/**
+ * Helper method that samples the location of the pages of the region,
+ * relative to the node of the process.
+ */
+int numaGetPlacement(const numa_t *numa, const void *addr, size_t size,
+                     numaplace_t *place);
+
+/**
+ * Helper method that returns the CPU and the node of the calling thread.
+ */
+void numaGetCPU(int *cpu, int *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
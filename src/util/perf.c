@@ -0,0 +1,142 @@
+#include "common.h"
+#include "perf.h"
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+#define PERF_DTLB_MISS (PERF_COUNT_HW_CACHE_DTLB                  | \
+                        (PERF_COUNT_HW_CACHE_OP_READ        << 8) | \
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS    << 16))
+
+/**
+ * Structure that defines the event of each counter. The context switches are
+ * recorded in kernel-mode, and thus cannot be restricted to user-mode.
+ */
+static const struct
+{
+    uint32_t type;
+    uint64_t config;
+    int      is_kernel;
+} perf_events[PERF_NUM_COUNTERS] = {
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN,  FALSE }, // MINFLT
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ,  FALSE }, // MAJFLT
+    { PERF_TYPE_HW_CACHE, PERF_DTLB_MISS,                 FALSE }, // DTLB
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     FALSE }, // LLC
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, TRUE  }, // CSW
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       FALSE }, // CYCLES
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     FALSE }  // INSTR
+};
+
+/**
+ * Helper method that opens a counter for the calling process on any CPU.
+ */
+static int perfOpenEvent(perfcounter_t counter, int exclude_kernel)
+{
+    struct perf_event_attr attr;
+    
+    memset(&attr, 0, sizeof(struct perf_event_attr));
+    attr.size           = sizeof(struct perf_event_attr);
+    attr.type           = perf_events[counter].type;
+    attr.config         = perf_events[counter].config;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit        = 1;
+    attr.exclude_hv     = 1;
+    attr.exclude_kernel = exclude_kernel;
+    
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1,
+                   PERF_FLAG_FD_CLOEXEC);
+}
+
+void perfOpen(perf_t *perf)
+{
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        perf->fd[counter] = perfOpenEvent(counter, FALSE);
+        
+        // Fall back to user-mode if perf_event_paranoid does not allow more
+        if (perf->fd[counter] < 0 && (errno == EACCES || errno == EPERM) &&
+            !perf_events[counter].is_kernel)
+        {
+            perf->fd[counter] = perfOpenEvent(counter, TRUE);
+        }
+    }
+}
+
+void perfRead(const perf_t *perf, perfsample_t *sample)
+{
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        uint64_t data[3] = { 0 }; // value + time_enabled + time_running
+        
+        sample->value[counter] = PERF_UNAVAILABLE;
+        
+        if (perf->fd[counter] < 0 || read(perf->fd[counter], data,
+                                          sizeof(data)) != sizeof(data))
+        {
+            continue;
+        }
+        
+        // Extrapolate the value if the counter was multiplexed
+        if (data[2] > 0 && data[2] < data[1])
+        {
+            data[0] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        }
+        
+        sample->value[counter] = (int64_t)data[0];
+    }
+}
+
+void perfDiff(const perfsample_t *start, const perfsample_t *stop,
+              perfsample_t *delta)
+{
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        delta->value[counter] = (start->value[counter] == PERF_UNAVAILABLE ||
+                                 stop->value[counter]  == PERF_UNAVAILABLE) ?
+                                PERF_UNAVAILABLE :
+                                (stop->value[counter] - start->value[counter]);
+    }
+}
+
+int perfReduce(const perfsample_t *sample, perfsample_t *sample_all, int root,
+               MPI_Comm comm) __CHK_FN__
+{
+    int64_t value[PERF_NUM_COUNTERS]         = { 0 };
+    int     is_available[PERF_NUM_COUNTERS]  = { 0 };
+    int     all_available[PERF_NUM_COUNTERS] = { 0 };
+    
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        is_available[counter] = (sample->value[counter] != PERF_UNAVAILABLE);
+        value[counter]        = (is_available[counter]) ?
+                                sample->value[counter] : 0;
+    }
+    
+    CHK(MPI_Reduce(value, sample_all->value, PERF_NUM_COUNTERS, MPI_INT64_T,
+                   MPI_SUM, root, comm));
+    CHK(MPI_Reduce(is_available, all_available, PERF_NUM_COUNTERS, MPI_INT,
+                   MPI_MIN, root, comm));
+    
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        if (!all_available[counter])
+        {
+            sample_all->value[counter] = PERF_UNAVAILABLE;
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void perfClose(perf_t *perf)
+{
+    for (int counter = 0; counter < PERF_NUM_COUNTERS; counter++)
+    {
+        if (perf->fd[counter] >= 0)
+        {
+            close(perf->fd[counter]);
+            perf->fd[counter] = -1;
+        }
+    }
+}
+
@@ -0,0 +1,83 @@
+#ifndef _PERF_H
+#define _PERF_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERF_UNAVAILABLE -1
+
+/**
+ * Enumerate that defines the index of each counter in a sample.
+ */
+typedef enum
+{
+    PERF_MINFLT = 0,
+    PERF_MAJFLT,
+    PERF_DTLB,
+    PERF_LLC,
+    PERF_CSW,
+    PERF_CYCLES,
+    PERF_INSTR,
+    PERF_NUM_COUNTERS
+} perfcounter_t;
+
+/**
+ * Structure that contains the perf_event descriptors of the process. The
+ * counters that could not be opened (e.g., no PMU access) remain at -1.
+ */
+typedef struct
+{
+    int fd[PERF_NUM_COUNTERS];
+} perf_t;
+
+/**
+ * Structure that contains a snapshot (or a delta) of the counters. The
+ * counters that are not available are set to PERF_UNAVAILABLE.
+ */
+typedef struct
+{
+    int64_t value[PERF_NUM_COUNTERS];
+} perfsample_t;
+
+/**
+ * Helper method that opens the counters for the calling process. The counters
+ * are inherited by the threads created afterwards. If the kernel does not
+ * allow to profile kernel-mode, the counters are restricted to user-mode, and
+ * the counters that cannot be opened are reported as unavailable.
+ */
+void perfOpen(perf_t *perf);
+
+/**
+ * Helper method that reads the current value of the counters. The values are
+ * scaled if the hardware counters were multiplexed.
+ */
+void perfRead(const perf_t *perf, perfsample_t *sample);
+
+/**
+ * Helper method that computes the difference between two snapshots.
+ */
+void perfDiff(const perfsample_t *start, const perfsample_t *stop,
+              perfsample_t *delta);
+
+/**
+ * Helper method that accumulates the counters of all the processes of the
+ * communicator into the root process. A counter is only available in the
+ * result if it was available in every process.
+ */
+int perfReduce(const perfsample_t *sample, perfsample_t *sample_all, int root,
+               MPI_Comm comm);
+
+/**
+ * Helper method that closes the counters.
+ */
+void perfClose(perf_t *perf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
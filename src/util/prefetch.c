@@ -0,0 +1,219 @@
+#include "common.h"
+#include "prefetch.h"
+
+/**
+ * Helper method that returns the offset of the n-th chunk of the pattern.
+ */
+static inline off_t getOffset(const prefetchpattern_t *pattern,
+                              uint64_t chunk)
+{
+    return pattern->base + (off_t)((pattern->offset_init +
+                                    chunk * pattern->padding) %
+                                   pattern->region_size);
+}
+
+/**
+ * Helper method that requests the n-th chunk of the pattern through the
+ * mapping (i.e., the region is extended to the page boundaries).
+ */
+static int requestChunk(prefetch_t *prefetch, uint64_t chunk) __CHK_FN__
+{
+    const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t addr      = (uintptr_t)prefetch->baseptr +
+                                getOffset(&prefetch->pattern, chunk);
+    const uintptr_t start     = addr & ~(page_size - 1);
+    const uintptr_t end       = addr + prefetch->pattern.chunk_size;
+    
+    if (prefetch->mode == PREFETCH_ADVISE)
+    {
+        CHKB((madvise((void *)start, (end - start), MADV_WILLNEED) < 0),
+             errno);
+    }
+    else
+    {
+        for (uintptr_t page = start; page < end; page += page_size)
+        {
+            (void)*(volatile char *)page;
+        }
+    }
+    
+    prefetch->num_issued++;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that requests the chunks that fall within the distance of
+ * the stream. The chunks that the stream completes first are skipped (i.e.,
+ * the prefetcher is late), and the thread yields while it is ahead.
+ */
+static void *launchPrefetch(void *arg)
+{
+    prefetch_t     *prefetch  = (prefetch_t *)arg;
+    const uint64_t num_chunks = prefetch->pattern.num_chunks;
+    
+    while (__atomic_load_n(&prefetch->is_active, __ATOMIC_ACQUIRE) &&
+           prefetch->next < num_chunks)
+    {
+        const uint64_t chunk = __atomic_load_n(&prefetch->progress->num_ops,
+                                               __ATOMIC_RELAXED) -
+                               prefetch->first_op;
+        const uint64_t limit = chunk + prefetch->distance;
+        
+        if (prefetch->next < chunk)
+        {
+            prefetch->num_late += chunk - prefetch->next;
+            prefetch->next      = chunk;
+        }
+        
+        if (prefetch->next > limit || prefetch->next >= num_chunks)
+        {
+            sched_yield();
+        }
+        else if ((prefetch->result = requestChunk(prefetch,
+                                                  prefetch->next++)))
+        {
+            break;
+        }
+    }
+    
+    return NULL;
+}
+
+int prefetchStart(prefetch_t *prefetch, prefetchmode_t mode, char *baseptr,
+                  MPI_File file, const progress_t *progress,
+                  const prefetchpattern_t *pattern, uint32_t distance,
+                  const cpu_set_t *cpus) __CHK_FN__
+{
+    CHKB((distance == 0), EINVAL);
+    
+    memset(prefetch, 0, sizeof(prefetch_t));
+    
+    prefetch->mode     = mode;
+    prefetch->baseptr  = baseptr;
+    prefetch->file     = file;
+    prefetch->progress = progress;
+    prefetch->pattern  = *pattern;
+    prefetch->distance = distance;
+    prefetch->first_op = progress->num_ops;
+    prefetch->next     = 1;
+    
+    if (mode == PREFETCH_READ)
+    {
+        prefetch->requests = (MPI_Request *)malloc(sizeof(MPI_Request) *
+                                                   distance);
+        prefetch->buffers  = (char *)malloc(pattern->chunk_size * distance);
+        prefetch->chunks   = (uint64_t *)malloc(sizeof(uint64_t) * distance);
+        CHKB((prefetch->requests == NULL || prefetch->buffers == NULL ||
+              prefetch->chunks == NULL), ENOMEM);
+        
+        for (uint32_t slot = 0; slot < distance; slot++)
+        {
+            prefetch->requests[slot] = MPI_REQUEST_NULL;
+            prefetch->chunks[slot]   = UINT64_MAX;
+        }
+    }
+    else
+    {
+        prefetch->is_active = TRUE;
+        
+        CHK(pthread_create(&prefetch->thread, NULL, launchPrefetch,
+                           prefetch));
+        
+        if (cpus != NULL)
+        {
+            CHK(pthread_setaffinity_np(prefetch->thread, sizeof(cpu_set_t),
+                                       cpus));
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int prefetchAdvance(prefetch_t *prefetch, uint64_t chunk) __CHK_FN__
+{
+    const uint64_t limit = chunk + prefetch->distance;
+    
+    for (; prefetch->mode == PREFETCH_READ && prefetch->next <= limit &&
+           prefetch->next < prefetch->pattern.num_chunks; prefetch->next++)
+    {
+        // The even chunks of the pattern are written
+        if (prefetch->next & 1)
+        {
+            const size_t   length   = prefetch->pattern.chunk_size;
+            const uint32_t slot     = prefetch->num_issued++ %
+                                      prefetch->distance;
+            MPI_Request    *request = &prefetch->requests[slot];
+            char           *buffer  = &prefetch->buffers[slot * length];
+            
+            // Reuse the buffer of the oldest pending read
+            CHK(MPI_Wait(request, MPI_STATUS_IGNORE));
+            CHK(MPI_File_iread_at(prefetch->file,
+                                  getOffset(&prefetch->pattern,
+                                            prefetch->next),
+                                  buffer, length, MPI_BYTE, request));
+            prefetch->chunks[slot] = prefetch->next;
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int prefetchConsume(prefetch_t *prefetch, uint64_t chunk, void *buffer,
+                    int *is_consumed) __CHK_FN__
+{
+    const size_t length = prefetch->pattern.chunk_size;
+    int          flag   = FALSE;
+    
+    *is_consumed = FALSE;
+    
+    // The slots are assigned in order, one for each requested chunk
+    for (uint32_t slot = 0; prefetch->mode == PREFETCH_READ &&
+                            slot < prefetch->distance; slot++)
+    {
+        if (prefetch->chunks[slot] == chunk)
+        {
+            CHK(MPI_Test(&prefetch->requests[slot], &flag,
+                         MPI_STATUS_IGNORE));
+            
+            if (!flag)
+            {
+                prefetch->num_late++;
+                CHK(MPI_Wait(&prefetch->requests[slot], MPI_STATUS_IGNORE));
+            }
+            
+            memcpy(buffer, &prefetch->buffers[slot * length], length);
+            prefetch->chunks[slot] = UINT64_MAX;
+            *is_consumed           = TRUE;
+            break;
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int prefetchStop(prefetch_t *prefetch) __CHK_FN__
+{
+    if (prefetch->mode == PREFETCH_READ)
+    {
+        CHK(MPI_Waitall(prefetch->distance, prefetch->requests,
+                        MPI_STATUSES_IGNORE));
+    }
+    else
+    {
+        __atomic_store_n(&prefetch->is_active, FALSE, __ATOMIC_RELEASE);
+        CHK(pthread_join(prefetch->thread, NULL));
+        CHK(prefetch->result);
+    }
+    
+    free(prefetch->requests);
+    free(prefetch->buffers);
+    free(prefetch->chunks);
+    
+    prefetch->requests = NULL;
+    prefetch->buffers  = NULL;
+    prefetch->chunks   = NULL;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,101 @@
+#ifndef _PREFETCH_H
+#define _PREFETCH_H
+
+#include <mpi.h>
+#include <sched.h>
+#include <pthread.h>
+#include "sampler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enumerate that defines how the chunks ahead of the accesses are requested.
+ */
+typedef enum
+{
+    PREFETCH_ADVISE = 0, // madvise(MADV_WILLNEED) on the mapping (thread)
+    PREFETCH_TOUCH,      // Read one byte of each page of the mapping (thread)
+    PREFETCH_READ        // Non-blocking MPI-IO reads (inline)
+} prefetchmode_t;
+
+/**
+ * Structure that describes a padding pattern (i.e., the n-th chunk is found
+ * at base + (offset_init + n * padding) % region_size), which makes the
+ * offsets ahead of the accesses predictable.
+ */
+typedef struct
+{
+    off_t    base;
+    size_t   region_size;
+    off_t    offset_init;
+    size_t   padding;
+    size_t   chunk_size;
+    uint64_t num_chunks;
+} prefetchpattern_t;
+
+/**
+ * Structure that represents the prefetcher of an access stream. The mapped
+ * modes launch a helper thread that follows the progress of the stream,
+ * while the reads are issued by the stream itself (i.e., MPI is not
+ * initialized with multi-threading support). On the latter, only the read
+ * operations are requested (i.e., every odd chunk of the pattern), and the
+ * stream consumes the buffers instead of reading the chunks again.
+ */
+typedef struct
+{
+    pthread_t         thread;
+    prefetchmode_t    mode;
+    char              *baseptr;
+    MPI_File          file;
+    const progress_t  *progress;
+    prefetchpattern_t pattern;
+    uint32_t          distance;
+    uint64_t          first_op;
+    uint64_t          next;
+    int               is_active;
+    int               result;
+    MPI_Request       *requests;
+    char              *buffers;
+    uint64_t          *chunks;
+    uint64_t          num_issued;
+    uint64_t          num_late;
+} prefetch_t;
+
+/**
+ * Helper method that launches the prefetcher, which requests up to the given
+ * number of chunks (i.e., distance) ahead of the stream. The helper thread
+ * is bound to the given CPUs, if provided (e.g., instead of sharing the CPU
+ * of the pinned stream).
+ */
+int prefetchStart(prefetch_t *prefetch, prefetchmode_t mode, char *baseptr,
+                  MPI_File file, const progress_t *progress,
+                  const prefetchpattern_t *pattern, uint32_t distance,
+                  const cpu_set_t *cpus);
+
+/**
+ * Helper method that issues the reads ahead of the given chunk of the
+ * pattern, before the stream accesses it. The mapped modes are ignored.
+ */
+int prefetchAdvance(prefetch_t *prefetch, uint64_t chunk);
+
+/**
+ * Helper method that waits for the read of the given chunk of the pattern, if
+ * requested, and copies it into the buffer. The reads that are still pending
+ * once the stream reaches them are counted as late.
+ */
+int prefetchConsume(prefetch_t *prefetch, uint64_t chunk, void *buffer,
+                    int *is_consumed);
+
+/**
+ * Helper method that stops the prefetcher and waits for the pending reads.
+ */
+int prefetchStop(prefetch_t *prefetch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,178 @@
+#include "common.h"
+#include "record.h"
+#include <sys/utsname.h>
+#include <math.h>
+
+extern char **environ;
+
+/**
+ * Helper method that writes a string with the JSON escape sequences.
+ */
+static void printEscaped(FILE *file, const char *str)
+{
+    fputc('"', file);
+    
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            fprintf(file, "\\%c", *str);
+        }
+        else if ((unsigned char)*str < 0x20)
+        {
+            fprintf(file, "\\u%04x", (unsigned char)*str);
+        }
+        else
+        {
+            fputc(*str, file);
+        }
+    }
+    
+    fputc('"', file);
+}
+
+/**
+ * Helper method that writes the key of the next member of the current
+ * object, preceded by the separator if needed.
+ */
+static void printKey(record_t *record, const char *key)
+{
+    if (!record->is_first[record->depth])
+    {
+        fputc(',', record->file);
+    }
+    
+    record->is_first[record->depth] = FALSE;
+    printEscaped(record->file, key);
+    fputc(':', record->file);
+}
+
+int recordOpen(record_t *record, const char *filename) __CHK_FN__
+{
+    memset(record, 0, sizeof(record_t));
+    
+    record->file = fopen(filename, "a");
+    CHKB((record->file == NULL), errno);
+    
+    record->is_first[0] = TRUE;
+    fputc('{', record->file);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void recordBegin(record_t *record, const char *key)
+{
+    printKey(record, key);
+    fputc('{', record->file);
+    
+    record->depth++;
+    record->is_first[record->depth] = TRUE;
+}
+
+void recordEnd(record_t *record)
+{
+    fputc('}', record->file);
+    record->depth--;
+}
+
+void recordString(record_t *record, const char *key, const char *value)
+{
+    printKey(record, key);
+    printEscaped(record->file, value);
+}
+
+void recordInt(record_t *record, const char *key, int64_t value)
+{
+    printKey(record, key);
+    fprintf(record->file, "%ld", (long)value);
+}
+
+void recordDouble(record_t *record, const char *key, double value)
+{
+    printKey(record, key);
+    
+    // JSON does not support the special values
+    if (isfinite(value))
+    {
+        fprintf(record->file, "%.9g", value);
+    }
+    else
+    {
+        fprintf(record->file, "null");
+    }
+}
+
+void recordStats(record_t *record, const char *key, const stats_t *stats)
+{
+    recordBegin(record, key);
+    recordInt(record,    "n",        stats->num_values);
+    recordInt(record,    "outliers", stats->num_outliers);
+    recordDouble(record, "min",      stats->min);
+    recordDouble(record, "median",   stats->median);
+    recordDouble(record, "max",      stats->max);
+    recordDouble(record, "mean",     stats->mean);
+    recordDouble(record, "stddev",   stats->stddev);
+    recordDouble(record, "ci95",     stats->ci);
+    recordEnd(record);
+}
+
+void recordHost(record_t *record, const char *key)
+{
+    int            length = 0;
+    time_t         now    = time(NULL);
+    struct utsname name;
+    char           hostname[HOST_NAME_MAX + 1];
+    char           library[MPI_MAX_LIBRARY_VERSION_STRING];
+    char           date[32];
+    
+    memset(hostname, 0, sizeof(hostname));
+    gethostname(hostname, HOST_NAME_MAX);
+    uname(&name);
+    MPI_Get_library_version(library, &length);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    
+    // Only keep the first line of the library version
+    library[strcspn(library, "\n")] = '\0';
+    
+    recordBegin(record, key);
+    recordString(record, "hostname", hostname);
+    recordString(record, "sysname",  name.sysname);
+    recordString(record, "release",  name.release);
+    recordString(record, "machine",  name.machine);
+    recordInt(record,    "cpus",     sysconf(_SC_NPROCESSORS_ONLN));
+    recordInt(record,    "pagesize", sysconf(_SC_PAGESIZE));
+    recordString(record, "mpi",      library);
+    recordString(record, "date",     date);
+    recordEnd(record);
+}
+
+void recordEnv(record_t *record, const char *key, const char *prefix)
+{
+    const size_t prefix_len = strlen(prefix);
+    
+    recordBegin(record, key);
+    
+    for (char **env = environ; *env != NULL; env++)
+    {
+        const char *value = strchr(*env, '=');
+        
+        if (value != NULL && !strncmp(*env, prefix, prefix_len))
+        {
+            char name[256] = { 0 };
+            
+            strncpy(name, *env, ((value - *env) < 255) ? (value - *env) : 255);
+            recordString(record, name, (value + 1));
+        }
+    }
+    
+    recordEnd(record);
+}
+
+int recordClose(record_t *record) __CHK_FN__
+{
+    fprintf(record->file, "}\n");
+    CHK(fclose(record->file));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,73 @@
+#ifndef _RECORD_H
+#define _RECORD_H
+
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_MAX_DEPTH 8
+
+/**
+ * Structure that represents a self-describing record, written as a single
+ * JSON object per line (i.e., JSON Lines) so that the records of several runs
+ * can be appended to the same file.
+ */
+typedef struct
+{
+    FILE     *file;
+    uint32_t depth;
+    int      is_first[RECORD_MAX_DEPTH];
+} record_t;
+
+/**
+ * Helper method that opens the record, appending it to the given file.
+ */
+int recordOpen(record_t *record, const char *filename);
+
+/**
+ * Helper method that opens a nested object with the given key.
+ */
+void recordBegin(record_t *record, const char *key);
+
+/**
+ * Helper method that closes the last nested object.
+ */
+void recordEnd(record_t *record);
+
+/**
+ * Helper methods that write a key-value pair into the current object.
+ */
+void recordString(record_t *record, const char *key, const char *value);
+void recordInt(record_t *record, const char *key, int64_t value);
+void recordDouble(record_t *record, const char *key, double value);
+
+/**
+ * Helper method that writes a summary as a nested object.
+ */
+void recordStats(record_t *record, const char *key, const stats_t *stats);
+
+/**
+ * Helper method that writes the metadata of the host (e.g., the kernel, the
+ * number of CPUs and the MPI library) as a nested object.
+ */
+void recordHost(record_t *record, const char *key);
+
+/**
+ * Helper method that writes the environment variables that start with the
+ * given prefix (i.e., the optional settings) as a nested object.
+ */
+void recordEnv(record_t *record, const char *key, const char *prefix);
+
+/**
+ * Helper method that closes the record and the file.
+ */
+int recordClose(record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,156 @@
+#include "common.h"
+#include "rma.h"
+
+/**
+ * Helper method that selects the target rank of the next operation.
+ */
+static inline int rmaNextTarget(rma_t *rma)
+{
+    const uint64_t op = rma->num_ops++;
+    
+    switch (rma->target)
+    {
+        case RMA_TARGET_NEIGHBOR:
+            return (rma->rank + 1) % rma->num_procs;
+        case RMA_TARGET_ALL:
+            return (int)((rma->rank + op) % rma->num_procs);
+        case RMA_TARGET_RANDOM:
+            return rand_r(&rma->seed) % rma->num_procs;
+        default: // RMA_TARGET_SELF
+            return rma->rank;
+    }
+}
+
+int rmaInit(rma_t *rma, MPI_Win win, rmatarget_t target, uint32_t batch,
+            size_t buffer_size) __CHK_FN__
+{
+    MPI_Group group = MPI_GROUP_NULL;
+    
+    memset(rma, 0, sizeof(rma_t));
+    
+    CHK(MPI_Win_get_group(win, &group));
+    CHK(MPI_Group_rank(group, &rma->rank));
+    CHK(MPI_Group_size(group, &rma->num_procs));
+    CHK(MPI_Group_free(&group));
+    
+    rma->win         = win;
+    rma->target      = target;
+    rma->seed        = (rma->rank + 1) * 921;
+    rma->batch       = (batch > 0) ? batch : 1;
+    rma->buffer_size = buffer_size;
+    
+    if (rma->batch > 1)
+    {
+        rma->requests = (MPI_Request *)malloc(sizeof(MPI_Request) *
+                                              rma->batch);
+        rma->buffers  = (char *)malloc(buffer_size * rma->batch);
+        CHKB((rma->requests == NULL || rma->buffers == NULL), ENOMEM);
+    }
+    
+    if (target == RMA_TARGET_SELF)
+    {
+        CHK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rma->rank, 0, win));
+    }
+    else
+    {
+        CHK(MPI_Win_lock_all(0, win));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int rmaSubmit(rma_t *rma, off_t offset, void *buffer, size_t length,
+              int is_write) __CHK_FN__
+{
+    const int target = rmaNextTarget(rma);
+    
+    if (rma->batch > 1)
+    {
+        MPI_Request *request = &rma->requests[rma->num_pending];
+        char        *staging = &rma->buffers[rma->num_pending *
+                                             rma->buffer_size];
+        
+        CHKB((length > rma->buffer_size), EINVAL);
+        
+        // The buffer of the caller can be reused before the flush
+        if (is_write)
+        {
+            memcpy(staging, buffer, length);
+            CHK(MPI_Rput(staging, length, MPI_BYTE, target, offset, length,
+                         MPI_BYTE, rma->win, request));
+        }
+        else
+        {
+            CHK(MPI_Rget(staging, length, MPI_BYTE, target, offset, length,
+                         MPI_BYTE, rma->win, request));
+        }
+        
+        if (++rma->num_pending == rma->batch)
+        {
+            CHK(rmaDrain(rma));
+        }
+    }
+    else
+    {
+        if (is_write)
+        {
+            CHK(MPI_Put(buffer, length, MPI_BYTE, target, offset, length,
+                        MPI_BYTE, rma->win));
+        }
+        else
+        {
+            CHK(MPI_Get(buffer, length, MPI_BYTE, target, offset, length,
+                        MPI_BYTE, rma->win));
+        }
+        
+        CHK(MPI_Win_flush_local(target, rma->win));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int rmaDrain(rma_t *rma) __CHK_FN__
+{
+    if (rma->num_pending > 0)
+    {
+        CHK(MPI_Waitall(rma->num_pending, rma->requests,
+                        MPI_STATUSES_IGNORE));
+        rma->num_pending = 0;
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int rmaSync(rma_t *rma) __CHK_FN__
+{
+    CHK(rmaDrain(rma));
+    
+    if (rma->target != RMA_TARGET_SELF)
+    {
+        CHK(MPI_Win_flush_all(rma->win));
+    }
+    
+    CHK(MPI_Win_sync(rma->win));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int rmaFree(rma_t *rma) __CHK_FN__
+{
+    CHK(rmaDrain(rma));
+    
+    if (rma->target == RMA_TARGET_SELF)
+    {
+        CHK(MPI_Win_unlock(rma->rank, rma->win));
+    }
+    else
+    {
+        CHK(MPI_Win_unlock_all(rma->win));
+    }
+    
+    free(rma->requests);
+    free(rma->buffers);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,80 @@
+#ifndef _RMA_H
+#define _RMA_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enumerate that defines the rank targeted by each one-sided operation.
+ */
+typedef enum
+{
+    RMA_TARGET_SELF = 0, // Window of the calling process
+    RMA_TARGET_NEIGHBOR, // Window of the next process (i.e., ring)
+    RMA_TARGET_ALL,      // Windows of every process (i.e., round-robin)
+    RMA_TARGET_RANDOM    // Window of a random process
+} rmatarget_t;
+
+/**
+ * Structure that represents the passive-target epoch of a window, with its
+ * own set of staging buffers (i.e., one buffer for each operation that can be
+ * pending before a flush).
+ */
+typedef struct
+{
+    MPI_Win     win;
+    int         rank;
+    int         num_procs;
+    rmatarget_t target;
+    uint32_t    seed;
+    uint64_t    num_ops;
+    uint32_t    batch;
+    uint32_t    num_pending;
+    MPI_Request *requests;
+    char        *buffers;
+    size_t      buffer_size;
+} rma_t;
+
+/**
+ * Helper method that opens a passive-target epoch over the window. The window
+ * of the calling process is locked in exclusive mode, while the remote
+ * targets lock every window in shared mode. If the batch is larger than one,
+ * the operations are request-based and flushed once per batch.
+ */
+int rmaInit(rma_t *rma, MPI_Win win, rmatarget_t target, uint32_t batch,
+            size_t buffer_size);
+
+/**
+ * Helper method that issues a put / get of the buffer at the given offset of
+ * the next target window. The call only blocks once the batch is full, and
+ * the data is staged on the buffers of the epoch when batched.
+ */
+int rmaSubmit(rma_t *rma, off_t offset, void *buffer, size_t length,
+              int is_write);
+
+/**
+ * Helper method that waits for the local completion of the pending
+ * operations (i.e., the buffers can be reused).
+ */
+int rmaDrain(rma_t *rma);
+
+/**
+ * Helper method that drains the pending operations and completes them at the
+ * target windows, synchronizing the public and private copies.
+ */
+int rmaSync(rma_t *rma);
+
+/**
+ * Helper method that closes the epoch and releases the staging buffers.
+ */
+int rmaFree(rma_t *rma);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
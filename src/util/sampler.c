@@ -0,0 +1,217 @@
+#include "common.h"
+#include "sampler.h"
+
+#define SAMPLER_INIT_SAMPLES 1024
+
+/**
+ * Helper method that returns a monotonic timestamp in nanoseconds.
+ */
+static uint64_t getTime(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return ((uint64_t)ts.tv_sec * __UINT64_C(1000000000) + ts.tv_nsec);
+}
+
+/**
+ * Helper method that records the accumulated progress of the threads. The
+ * buffers are only accessed by the sampler thread while it is active.
+ */
+static int recordSample(sampler_t *sampler) __CHK_FN__
+{
+    const uint32_t index     = sampler->num_samples;
+    uint64_t       num_bytes = 0;
+    uint64_t       num_ops   = 0;
+    
+    if (index == sampler->max_samples)
+    {
+        const uint32_t max_samples = (index > 0) ? (index << 1) :
+                                                   SAMPLER_INIT_SAMPLES;
+        const size_t   size        = sizeof(uint64_t) * max_samples;
+        uint64_t       *time       = (uint64_t *)realloc(sampler->time, size);
+        uint64_t       *bytes      = NULL;
+        uint64_t       *ops        = NULL;
+        
+        // The previous buffers are kept on failure (i.e., for samplerFree),
+        // and the capacity only grows once every buffer has been resized
+        CHKB((time == NULL), ENOMEM);
+        sampler->time = time;
+        
+        bytes = (uint64_t *)realloc(sampler->num_bytes, size);
+        CHKB((bytes == NULL), ENOMEM);
+        sampler->num_bytes = bytes;
+        
+        ops = (uint64_t *)realloc(sampler->num_ops, size);
+        CHKB((ops == NULL), ENOMEM);
+        sampler->num_ops = ops;
+        
+        sampler->max_samples = max_samples;
+    }
+    
+    for (uint32_t i = 0; i < sampler->num_progress; i++)
+    {
+        num_bytes += __atomic_load_n(&sampler->progress[i]->num_bytes,
+                                     __ATOMIC_RELAXED);
+        num_ops   += __atomic_load_n(&sampler->progress[i]->num_ops,
+                                     __ATOMIC_RELAXED);
+    }
+    
+    sampler->time[index]      = getTime() - sampler->start;
+    sampler->num_bytes[index] = num_bytes;
+    sampler->num_ops[index]   = num_ops;
+    sampler->num_samples++;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that records a sample at the end of each interval. The
+ * intervals are absolute, so that the time to record does not drift.
+ */
+static void *launchSampler(void *arg)
+{
+    sampler_t       *sampler = (sampler_t *)arg;
+    struct timespec next     = { 0 };
+    
+    next.tv_sec  = sampler->start / 1000000000;
+    next.tv_nsec = sampler->start % 1000000000;
+    
+    while (__atomic_load_n(&sampler->is_active, __ATOMIC_ACQUIRE))
+    {
+        next.tv_nsec += (long)sampler->interval_ms * 1000000;
+        next.tv_sec  += next.tv_nsec / 1000000000;
+        next.tv_nsec  = next.tv_nsec % 1000000000;
+        
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+                               NULL) == EINTR);
+        
+        if (recordSample(sampler))
+        {
+            break;
+        }
+    }
+    
+    return NULL;
+}
+
+int samplerStart(sampler_t *sampler, const progress_t **progress,
+                 uint32_t num_progress, uint32_t interval_ms) __CHK_FN__
+{
+    memset(sampler, 0, sizeof(sampler_t));
+    
+    sampler->progress     = progress;
+    sampler->num_progress = num_progress;
+    sampler->interval_ms  = (interval_ms > 0) ? interval_ms : 1;
+    sampler->is_active    = TRUE;
+    sampler->start        = getTime();
+    
+    CHK(pthread_create(&sampler->thread, NULL, launchSampler, sampler));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int samplerStop(sampler_t *sampler) __CHK_FN__
+{
+    __atomic_store_n(&sampler->is_active, FALSE, __ATOMIC_RELEASE);
+    CHK(pthread_join(sampler->thread, NULL));
+    
+    // Record the progress since the last interval
+    CHK(recordSample(sampler));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int samplerPrint(const sampler_t *sampler, int is_merged, int root,
+                 MPI_Comm comm) __CHK_FN__
+{
+    int      rank        = 0;
+    int      num_procs   = 0;
+    uint32_t max_samples = 0;
+    uint64_t *delta      = NULL;
+    uint64_t *delta_all  = NULL;
+    uint64_t *time       = NULL;
+    uint64_t *time_all   = NULL;
+    
+    CHK(MPI_Comm_rank(comm, &rank));
+    CHK(MPI_Comm_size(comm, &num_procs));
+    
+    // Print the series of each process (in order)
+    for (int drank = 0; drank < num_procs; drank++)
+    {
+        CHK(MPI_Barrier(comm));
+        
+        for (uint32_t i = 0; i < sampler->num_samples && drank == rank; i++)
+        {
+            const uint64_t time_prev  = (i > 0) ? sampler->time[i - 1] : 0;
+            const uint64_t bytes_prev = (i > 0) ? sampler->num_bytes[i - 1] : 0;
+            const uint64_t ops_prev   = (i > 0) ? sampler->num_ops[i - 1] : 0;
+            const uint64_t num_bytes  = sampler->num_bytes[i] - bytes_prev;
+            
+            printf("sample;%d;%u;%lf; %lu;%lu;%lf\n", rank, i,
+                   sampler->time[i] / 1000000000.0, (unsigned long)num_bytes,
+                   (unsigned long)(sampler->num_ops[i] - ops_prev),
+                   (num_bytes / 1048576.0) /
+                   ((sampler->time[i] - time_prev) / 1000000000.0));
+        }
+    }
+    
+    // Align the series by interval (i.e., zero-padded) and merge them. As the
+    // last interval is partial, the duration of each interval is taken from
+    // the latest sample of the processes
+    if (is_merged)
+    {
+        CHK(MPI_Allreduce(&sampler->num_samples, &max_samples, 1, MPI_UINT32_T,
+                          MPI_MAX, comm));
+        
+        delta     = (uint64_t *)calloc((max_samples << 1), sizeof(uint64_t));
+        delta_all = (uint64_t *)calloc((max_samples << 1), sizeof(uint64_t));
+        time      = (uint64_t *)calloc(max_samples, sizeof(uint64_t));
+        time_all  = (uint64_t *)calloc(max_samples, sizeof(uint64_t));
+        
+        for (uint32_t i = 0; i < sampler->num_samples; i++)
+        {
+            time[i]             = sampler->time[i];
+            delta[i << 1]       = sampler->num_bytes[i] -
+                                  ((i > 0) ? sampler->num_bytes[i - 1] : 0);
+            delta[(i << 1) + 1] = sampler->num_ops[i] -
+                                  ((i > 0) ? sampler->num_ops[i - 1] : 0);
+        }
+        
+        CHK(MPI_Reduce(delta, delta_all, (max_samples << 1), MPI_UINT64_T,
+                       MPI_SUM, root, comm));
+        CHK(MPI_Reduce(time, time_all, max_samples, MPI_UINT64_T, MPI_MAX,
+                       root, comm));
+        
+        for (uint32_t i = 0; i < max_samples && rank == root; i++)
+        {
+            const uint64_t time_prev = (i > 0) ? time_all[i - 1] : 0;
+            
+            printf("sample;all;%u;%lf; %lu;%lu;%lf\n", i,
+                   time_all[i] / 1000000000.0,
+                   (unsigned long)delta_all[i << 1],
+                   (unsigned long)delta_all[(i << 1) + 1],
+                   (delta_all[i << 1] / 1048576.0) /
+                   ((time_all[i] - time_prev) / 1000000000.0));
+        }
+        
+        free(delta);
+        free(delta_all);
+        free(time);
+        free(time_all);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void samplerFree(sampler_t *sampler)
+{
+    free(sampler->time);
+    free(sampler->num_bytes);
+    free(sampler->num_ops);
+    
+    sampler->num_samples = 0;
+    sampler->max_samples = 0;
+}
+
@@ -0,0 +1,83 @@
+#ifndef _SAMPLER_H
+#define _SAMPLER_H
+
+#include <mpi.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Structure that contains the progress of a thread (i.e., completed bytes and
+ * operations). The counters only have one writer, so that they are updated
+ * with relaxed stores instead of atomic read-modify-write operations.
+ */
+typedef struct
+{
+    uint64_t num_bytes;
+    uint64_t num_ops;
+} progress_t;
+
+/**
+ * Structure that represents a sampler thread, which periodically records the
+ * accumulated progress of a set of threads.
+ */
+typedef struct
+{
+    pthread_t        thread;
+    const progress_t **progress;
+    uint32_t         num_progress;
+    uint32_t         interval_ms;
+    int              is_active;
+    uint64_t         start;
+    uint64_t         *time;
+    uint64_t         *num_bytes;
+    uint64_t         *num_ops;
+    uint32_t         num_samples;
+    uint32_t         max_samples;
+} sampler_t;
+
+/**
+ * Helper method that updates the progress of the calling thread.
+ */
+static inline void progressAdd(progress_t *progress, uint64_t num_bytes)
+{
+    __atomic_store_n(&progress->num_bytes, (progress->num_bytes + num_bytes),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&progress->num_ops, (progress->num_ops + 1),
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * Helper method that launches the sampler thread, which records the progress
+ * of the given threads every interval (in milliseconds).
+ */
+int samplerStart(sampler_t *sampler, const progress_t **progress,
+                 uint32_t num_progress, uint32_t interval_ms);
+
+/**
+ * Helper method that stops the sampler thread, after recording a last sample.
+ */
+int samplerStop(sampler_t *sampler);
+
+/**
+ * Helper method that prints the time series of the process (i.e., the bytes
+ * and operations completed on each interval). If requested, the series of
+ * all the processes of the communicator are also merged into the root
+ * process, aligned by interval.
+ */
+int samplerPrint(const sampler_t *sampler, int is_merged, int root,
+                 MPI_Comm comm);
+
+/**
+ * Helper method that releases the samples.
+ */
+void samplerFree(sampler_t *sampler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,133 @@
+#include "common.h"
+#include "stats.h"
+#include <math.h>
+
+#define STATS_MAD_SCALE 0.6745 // Modified z-score (Iglewicz and Hoaglin)
+#define STATS_T_NORMAL  1.960  // Critical value above the table
+
+/**
+ * Critical values of the two-sided 95% Student's t-distribution, given the
+ * degrees of freedom (i.e., the normal value is used above the table).
+ */
+static const double t_values[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+/**
+ * Comparison function to sort the samples in ascending order.
+ */
+static int compareValues(const void *a, const void *b)
+{
+    const double value_a = *(const double *)a;
+    const double value_b = *(const double *)b;
+    
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+/**
+ * Helper method that returns the median of the sorted samples.
+ */
+static double getMedian(const double *values, uint32_t num_values)
+{
+    return (num_values == 0) ? 0.0 :
+           (num_values & 1) ? values[num_values >> 1] :
+           (values[(num_values >> 1) - 1] + values[num_values >> 1]) / 2.0;
+}
+
+void statsCompute(const double *values, uint32_t num_values,
+                  double outlier_z, stats_t *stats)
+{
+    double   *sorted    = (double *)malloc(sizeof(double) * (num_values + 1));
+    double   *deviation = (double *)malloc(sizeof(double) * (num_values + 1));
+    double   median     = 0.0;
+    double   mad        = 0.0;
+    uint32_t num_kept   = 0;
+    
+    memset(stats, 0, sizeof(stats_t));
+    memcpy(sorted, values, sizeof(double) * num_values);
+    qsort(sorted, num_values, sizeof(double), compareValues);
+    median = getMedian(sorted, num_values);
+    
+    for (uint32_t i = 0; i < num_values; i++)
+    {
+        deviation[i] = fabs(sorted[i] - median);
+    }
+    
+    qsort(deviation, num_values, sizeof(double), compareValues);
+    mad = getMedian(deviation, num_values);
+    
+    // Keep the samples in order, skipping the outliers (if any)
+    for (uint32_t i = 0; i < num_values; i++)
+    {
+        if (outlier_z > 0.0 && mad > 0.0 &&
+            (STATS_MAD_SCALE * fabs(sorted[i] - median) / mad) > outlier_z)
+        {
+            stats->num_outliers++;
+            continue;
+        }
+        
+        sorted[num_kept++] = sorted[i];
+        stats->mean       += sorted[i];
+    }
+    
+    if (num_kept > 0)
+    {
+        stats->num_values = num_kept;
+        stats->min        = sorted[0];
+        stats->median     = getMedian(sorted, num_kept);
+        stats->max        = sorted[num_kept - 1];
+        stats->mean      /= num_kept;
+    }
+    
+    for (uint32_t i = 0; i < num_kept; i++)
+    {
+        stats->stddev += (sorted[i] - stats->mean) * (sorted[i] - stats->mean);
+    }
+    
+    if (num_kept > 1)
+    {
+        const uint32_t num_df = num_kept - 1;
+        const double   t      = (num_df <= sizeof(t_values) / sizeof(double)) ?
+                                t_values[num_df - 1] : STATS_T_NORMAL;
+        
+        stats->stddev = sqrt(stats->stddev / num_df);
+        stats->ci     = t * stats->stddev / sqrt((double)num_kept);
+    }
+    else
+    {
+        stats->stddev = 0.0;
+    }
+    
+    free(sorted);
+    free(deviation);
+}
+
+int statsReduce(double value, stats_t *stats, int root, MPI_Comm comm)
+                                                                    __CHK_FN__
+{
+    int    rank      = 0;
+    int    num_procs = 0;
+    double *values   = NULL;
+    
+    CHK(MPI_Comm_rank(comm, &rank));
+    CHK(MPI_Comm_size(comm, &num_procs));
+    
+    if (rank == root)
+    {
+        values = (double *)malloc(sizeof(double) * num_procs);
+    }
+    
+    CHK(MPI_Gather(&value, 1, MPI_DOUBLE, values, 1, MPI_DOUBLE, root,
+                   comm));
+    
+    if (rank == root)
+    {
+        statsCompute(values, num_procs, 0.0, stats);
+        free(values);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
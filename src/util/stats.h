@@ -0,0 +1,46 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Structure that contains the summary of a set of samples, after rejecting
+ * the outliers (if requested). The confidence interval is given as the
+ * half-width of the 95% interval of the mean.
+ */
+typedef struct
+{
+    uint32_t num_values;
+    uint32_t num_outliers;
+    double   min;
+    double   median;
+    double   max;
+    double   mean;
+    double   stddev;
+    double   ci;
+} stats_t;
+
+/**
+ * Helper method that summarizes the samples. The samples whose modified
+ * z-score (i.e., based on the median absolute deviation) exceeds the
+ * threshold are rejected as outliers (zero means that all are kept).
+ */
+void statsCompute(const double *values, uint32_t num_values,
+                  double outlier_z, stats_t *stats);
+
+/**
+ * Helper method that summarizes the value of each process of the
+ * communicator into the root process (i.e., without rejecting outliers).
+ */
+int statsReduce(double value, stats_t *stats, int root, MPI_Comm comm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
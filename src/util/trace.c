@@ -0,0 +1,40 @@
+#include "common.h"
+#include "util.h"
+#include "trace.h"
+
+int openTrace(const char *filename, trace_t *trace) __CHK_FN__
+{
+    struct stat st = { 0 };
+    int         fd = -1;
+    
+    CHK(openFile(filename, O_RDONLY, FALSE, 0, &fd));
+    CHK(fstat(fd, &st));
+    CHKB((st.st_size < sizeof(trace_header_t)), EINVAL);
+    
+    // The trace is streamed during the benchmark (i.e., no parsing is needed)
+    trace->size    = st.st_size;
+    trace->header  = mmap(NULL, trace->size, PROT_READ, MAP_SHARED, fd, 0);
+    CHKB((trace->header == MAP_FAILED), errno);
+    CHK(close(fd));
+    CHK(madvise(trace->header, trace->size, MADV_SEQUENTIAL));
+    
+    trace->records = (trace_record_t *)&trace->header[1];
+    CHKB((trace->header->magic != TRACE_MAGIC ||
+          trace->size < sizeof(trace_header_t) + sizeof(trace_record_t) *
+                                                  trace->header->num_records),
+         EINVAL);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int closeTrace(trace_t *trace) __CHK_FN__
+{
+    CHK(munmap(trace->header, trace->size));
+    
+    trace->header  = NULL;
+    trace->records = NULL;
+    trace->size    = 0;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,60 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_MAGIC __UINT64_C(0x3145434152545355) // "USTRACE1"
+
+/**
+ * Header of a binary trace file, followed by the records of the trace.
+ */
+typedef struct
+{
+    uint64_t magic;
+    uint64_t num_records;
+    uint64_t total_size;
+    uint32_t max_length;
+    uint32_t reserved;
+} trace_header_t;
+
+/**
+ * Record of a binary trace file that describes a single read / write
+ * operation, with an optional think-time before the operation is issued.
+ */
+typedef struct
+{
+    uint64_t offset;
+    uint32_t length;
+    uint8_t  is_write;
+    uint8_t  reserved;
+    uint16_t think_us;
+} trace_record_t;
+
+/**
+ * Structure that represents a memory-mapped binary trace.
+ */
+typedef struct
+{
+    trace_header_t *header;
+    trace_record_t *records;
+    size_t         size;
+} trace_t;
+
+/**
+ * Helper method that maps a binary trace file into memory for streaming.
+ */
+int openTrace(const char *filename, trace_t *trace);
+
+/**
+ * Helper method that releases a memory-mapped binary trace.
+ */
+int closeTrace(trace_t *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
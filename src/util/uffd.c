@@ -0,0 +1,460 @@
+#include "common.h"
+#include "uffd.h"
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/userfaultfd.h>
+
+#define SEG_RESIDENT 0x1
+#define SEG_DIRTY    0x2
+#define SEG_STORED   0x4
+#define SEG_NONE     UINT64_MAX
+
+struct uffd
+{
+    int             uffd;
+    int             fd;
+    int             wake_fd[2];
+    off_t           offset;
+    char            *addr;
+    size_t          size;
+    size_t          seg_size;
+    uint64_t        num_segs;
+    uint64_t        max_resident;
+    uint64_t        num_resident;
+    int8_t          read_file;
+    int8_t          is_wp;
+    uffdptype_t     ptype;
+    uint8_t         *seg_state;
+    uint64_t        *seg_prev;
+    uint64_t        *seg_next;
+    uint64_t        seg_head;
+    uint64_t        seg_tail;
+    char            *buffer;
+    uint32_t        num_reads;
+    uint32_t        num_writes;
+    uint32_t        num_fills;
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+};
+
+/**
+ * Helper method that removes a segment from the list of resident segments.
+ */
+static void unlinkSegment(uffd_t *uffd, uint64_t seg)
+{
+    const uint64_t prev = uffd->seg_prev[seg];
+    const uint64_t next = uffd->seg_next[seg];
+    
+    if (prev != SEG_NONE)
+    {
+        uffd->seg_next[prev] = next;
+    }
+    else
+    {
+        uffd->seg_head = next;
+    }
+    
+    if (next != SEG_NONE)
+    {
+        uffd->seg_prev[next] = prev;
+    }
+    else
+    {
+        uffd->seg_tail = prev;
+    }
+}
+
+/**
+ * Helper method that appends a segment to the list of resident segments (i.e.,
+ * the segment becomes the last candidate for eviction).
+ */
+static void appendSegment(uffd_t *uffd, uint64_t seg)
+{
+    uffd->seg_prev[seg] = uffd->seg_tail;
+    uffd->seg_next[seg] = SEG_NONE;
+    
+    if (uffd->seg_tail != SEG_NONE)
+    {
+        uffd->seg_next[uffd->seg_tail] = seg;
+    }
+    else
+    {
+        uffd->seg_head = seg;
+    }
+    
+    uffd->seg_tail = seg;
+}
+
+/**
+ * Helper method that changes the write-protection of a segment.
+ */
+static int protectSegment(uffd_t *uffd, uint64_t seg, int8_t is_protected)
+                                                                      __CHK_FN__
+{
+    struct uffdio_writeprotect wp = { 0 };
+    
+    wp.range.start = (uintptr_t)&uffd->addr[seg * uffd->seg_size];
+    wp.range.len   = uffd->seg_size;
+    wp.mode        = (is_protected) ? UFFDIO_WRITEPROTECT_MODE_WP : 0;
+    
+    // The request is retried while the layout of the region changes
+    while (ioctl(uffd->uffd, UFFDIO_WRITEPROTECT, &wp) < 0)
+    {
+        CHKB((errno != EAGAIN), errno);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that writes a dirty segment back to the file. The segment is
+ * write-protected before, so that new writes are tracked again.
+ */
+static int flushSegment(uffd_t *uffd, uint64_t seg) __CHK_FN__
+{
+    const size_t offset = seg * uffd->seg_size;
+    const size_t length = ((offset + uffd->seg_size) > uffd->size) ?
+                          (uffd->size - offset) : uffd->seg_size;
+    
+    if (uffd->is_wp)
+    {
+        CHK(protectSegment(uffd, seg, TRUE));
+    }
+    
+    CHKB((pwrite(uffd->fd, &uffd->addr[offset], length,
+                 (uffd->offset + offset)) != length), EIO);
+    
+    uffd->seg_state[seg] = (uffd->seg_state[seg] & ~SEG_DIRTY) | SEG_STORED;
+    uffd->num_writes++;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that evicts the first candidate of the list of resident
+ * segments, writing it back to the file if dirty.
+ */
+static int evictSegment(uffd_t *uffd) __CHK_FN__
+{
+    const uint64_t seg = uffd->seg_head;
+    
+    if (uffd->seg_state[seg] & SEG_DIRTY)
+    {
+        CHK(flushSegment(uffd, seg));
+    }
+    
+    CHK(madvise(&uffd->addr[seg * uffd->seg_size], uffd->seg_size,
+                MADV_DONTNEED));
+    
+    unlinkSegment(uffd, seg);
+    uffd->seg_state[seg] &= SEG_STORED;
+    uffd->num_resident--;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that fills a segment from the file and maps it atomically
+ * into the region, which also wakes the faulting threads.
+ */
+static int fillSegment(uffd_t *uffd, uint64_t seg, int8_t is_write) __CHK_FN__
+{
+    const size_t       offset = seg * uffd->seg_size;
+    struct uffdio_copy copy   = { 0 };
+    
+    while (uffd->num_resident >= uffd->max_resident)
+    {
+        CHK(evictSegment(uffd));
+    }
+    
+    // Segments evicted before are always read back from the file
+    if (uffd->read_file || (uffd->seg_state[seg] & SEG_STORED))
+    {
+        ssize_t length = pread(uffd->fd, uffd->buffer, uffd->seg_size,
+                               (uffd->offset + offset));
+        CHKB((length < 0), errno);
+        
+        memset(&uffd->buffer[length], 0, (uffd->seg_size - length));
+        uffd->num_reads++;
+    }
+    else
+    {
+        memset(uffd->buffer, 0, uffd->seg_size);
+    }
+    
+    // Read faults install the segment write-protected to track writes
+    copy.dst  = (uintptr_t)&uffd->addr[offset];
+    copy.src  = (uintptr_t)uffd->buffer;
+    copy.len  = uffd->seg_size;
+    copy.mode = (uffd->is_wp && !is_write) ? UFFDIO_COPY_MODE_WP : 0;
+    
+    // The copy is also retried while the layout of the region changes, from
+    // the bytes that were already copied
+    while (ioctl(uffd->uffd, UFFDIO_COPY, &copy) < 0)
+    {
+        CHKB((errno != EAGAIN), errno);
+        
+        if (copy.copy > 0)
+        {
+            copy.dst += copy.copy;
+            copy.src += copy.copy;
+            copy.len -= copy.copy;
+        }
+        
+        copy.copy = 0;
+    }
+    
+    appendSegment(uffd, seg);
+    uffd->num_fills++;
+    uffd->seg_state[seg] |= SEG_RESIDENT | ((is_write || !uffd->is_wp) ?
+                                            SEG_DIRTY : 0);
+    uffd->num_resident++;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that services a single page-fault of the region.
+ */
+static int handleFault(uffd_t *uffd, const struct uffd_msg *msg) __CHK_FN__
+{
+    const uint64_t address  = msg->arg.pagefault.address;
+    const uint64_t flags    = msg->arg.pagefault.flags;
+    const uint64_t seg      = (address - (uintptr_t)uffd->addr) /
+                              uffd->seg_size;
+    const int8_t   is_write = ((flags & UFFD_PAGEFAULT_FLAG_WRITE) != 0);
+    
+    CHK(pthread_mutex_lock(&uffd->mutex));
+    
+    if (!(uffd->seg_state[seg] & SEG_RESIDENT))
+    {
+        // Write-protect faults on evicted segments are retried as missing
+        if (flags & UFFD_PAGEFAULT_FLAG_WP)
+        {
+            struct uffdio_range range = { 0 };
+            
+            range.start = address & ~((uint64_t)sysconf(_SC_PAGESIZE) - 1);
+            range.len   = sysconf(_SC_PAGESIZE);
+            CHK(ioctl(uffd->uffd, UFFDIO_WAKE, &range));
+        }
+        else
+        {
+            CHK(fillSegment(uffd, seg, is_write));
+        }
+    }
+    else if (flags & UFFD_PAGEFAULT_FLAG_WP)
+    {
+        // The first write marks the segment as dirty
+        uffd->seg_state[seg] |= SEG_DIRTY;
+        CHK(protectSegment(uffd, seg, FALSE));
+    }
+    else
+    {
+        // The segment was filled while the fault was queued
+        struct uffdio_range range = { 0 };
+        
+        range.start = (uintptr_t)&uffd->addr[seg * uffd->seg_size];
+        range.len   = uffd->seg_size;
+        CHK(ioctl(uffd->uffd, UFFDIO_WAKE, &range));
+    }
+    
+    // The recency of the segment is only known from its faults
+    if (uffd->ptype == UFFD_PTYPE_LRU && (uffd->seg_state[seg] & SEG_RESIDENT))
+    {
+        unlinkSegment(uffd, seg);
+        appendSegment(uffd, seg);
+    }
+    
+    CHK(pthread_mutex_unlock(&uffd->mutex));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Thread routine that services the page-faults of the region until the
+ * mapping is released.
+ */
+static void *launchHandler(void *arg)
+{
+    uffd_t        *uffd     = (uffd_t *)arg;
+    struct pollfd pollfd[2] = { { uffd->uffd, POLLIN, 0 },
+                                { uffd->wake_fd[0], POLLIN, 0 } };
+    
+    while (poll(pollfd, 2, -1) >= 0 || errno == EINTR)
+    {
+        struct uffd_msg msg = { 0 };
+        
+        if (pollfd[1].revents)
+        {
+            break;
+        }
+        
+        while (read(uffd->uffd, &msg, sizeof(struct uffd_msg)) ==
+               sizeof(struct uffd_msg))
+        {
+            if (msg.event == UFFD_EVENT_PAGEFAULT && handleFault(uffd, &msg))
+            {
+                fprintf(stderr, "Error: The page-fault at %p failed!\n",
+                        (void *)(uintptr_t)msg.arg.pagefault.address);
+                abort();
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+int uffdMap(size_t size, size_t seg_size, int fd, off_t offset, size_t budget,
+            int8_t read_file, uffdptype_t ptype, uffd_t **uffd_out,
+            void **addr) __CHK_FN__
+{
+    const size_t           page_size = sysconf(_SC_PAGESIZE);
+    uffd_t                 *uffd     = (uffd_t *)calloc(1, sizeof(uffd_t));
+    struct uffdio_api      api       = { 0 };
+    struct uffdio_register reg       = { 0 };
+    
+    uffd->fd           = fd;
+    uffd->offset       = offset;
+    uffd->size         = size;
+    uffd->seg_size     = ((seg_size + page_size - 1) / page_size) * page_size;
+    uffd->num_segs     = (size + uffd->seg_size - 1) / uffd->seg_size;
+    uffd->max_resident = (budget >= uffd->seg_size) ?
+                         (budget / uffd->seg_size) : uffd->num_segs;
+    uffd->read_file    = read_file;
+    uffd->ptype        = ptype;
+    uffd->seg_head     = SEG_NONE;
+    uffd->seg_tail     = SEG_NONE;
+    uffd->seg_state    = (uint8_t *)calloc(uffd->num_segs, sizeof(uint8_t));
+    uffd->seg_prev     = (uint64_t *)malloc(sizeof(uint64_t) * uffd->num_segs);
+    uffd->seg_next     = (uint64_t *)malloc(sizeof(uint64_t) * uffd->num_segs);
+    uffd->buffer       = (char *)malloc(uffd->seg_size);
+    
+    // Open the userfaultfd, restricted to user-space faults if possible
+    uffd->uffd = syscall(SYS_userfaultfd, (O_CLOEXEC | O_NONBLOCK |
+                                           UFFD_USER_MODE_ONLY));
+    
+    if (uffd->uffd < 0)
+    {
+        uffd->uffd = syscall(SYS_userfaultfd, (O_CLOEXEC | O_NONBLOCK));
+        CHKB((uffd->uffd < 0), errno);
+    }
+    
+    // Enable the write-protect mode, if supported, to track dirty segments
+    api.api      = UFFD_API;
+    api.features = UFFD_FEATURE_PAGEFAULT_FLAG_WP;
+    uffd->is_wp  = (ioctl(uffd->uffd, UFFDIO_API, &api) == 0);
+    
+    if (!uffd->is_wp)
+    {
+        // The handshake can only be performed once per userfaultfd
+        CHK(close(uffd->uffd));
+        uffd->uffd = syscall(SYS_userfaultfd, (O_CLOEXEC | O_NONBLOCK));
+        CHKB((uffd->uffd < 0), errno);
+        
+        api.features = 0;
+        CHK(ioctl(uffd->uffd, UFFDIO_API, &api));
+    }
+    
+    // Without write-protection, the writes that follow the write-back of an
+    // evicted segment would be discarded (i.e., no budget is supported)
+    CHKB((!uffd->is_wp && uffd->max_resident < uffd->num_segs), ENOTSUP);
+    
+    uffd->addr = mmap(NULL, (uffd->num_segs * uffd->seg_size),
+                      (PROT_READ | PROT_WRITE),
+                      (MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE), -1, 0);
+    CHKB((uffd->addr == MAP_FAILED), errno);
+    
+    reg.range.start = (uintptr_t)uffd->addr;
+    reg.range.len   = uffd->num_segs * uffd->seg_size;
+    reg.mode        = UFFDIO_REGISTER_MODE_MISSING |
+                      ((uffd->is_wp) ? UFFDIO_REGISTER_MODE_WP : 0);
+    CHK(ioctl(uffd->uffd, UFFDIO_REGISTER, &reg));
+    
+    CHK(pipe(uffd->wake_fd));
+    CHK(pthread_mutex_init(&uffd->mutex, NULL));
+    CHK(pthread_create(&uffd->thread, NULL, launchHandler, uffd));
+    
+    *uffd_out = uffd;
+    *addr     = uffd->addr;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uffdSync(uffd_t *uffd) __CHK_FN__
+{
+    CHK(pthread_mutex_lock(&uffd->mutex));
+    
+    for (uint64_t seg = uffd->seg_head; seg != SEG_NONE;
+         seg = uffd->seg_next[seg])
+    {
+        if (uffd->seg_state[seg] & SEG_DIRTY)
+        {
+            CHK(flushSegment(uffd, seg));
+        }
+    }
+    
+    CHK(pthread_mutex_unlock(&uffd->mutex));
+    CHK(fsync(uffd->fd));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uffdSetBudget(uffd_t *uffd, size_t budget) __CHK_FN__
+{
+    const uint64_t max_resident = (budget >= uffd->seg_size) ?
+                                  (budget / uffd->seg_size) : uffd->num_segs;
+    
+    CHKB((!uffd->is_wp && max_resident < uffd->num_segs), ENOTSUP);
+    CHK(pthread_mutex_lock(&uffd->mutex));
+    
+    uffd->max_resident = max_resident;
+    
+    while (uffd->num_resident > uffd->max_resident)
+    {
+        CHK(evictSegment(uffd));
+    }
+    
+    CHK(pthread_mutex_unlock(&uffd->mutex));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uffdUnmap(uffd_t *uffd, int8_t sync) __CHK_FN__
+{
+    if (sync)
+    {
+        CHK(uffdSync(uffd));
+    }
+    
+    // Stop the fault-servicing thread before releasing the region
+    CHKB((write(uffd->wake_fd[1], "", 1) != 1), EIO);
+    CHK(pthread_join(uffd->thread, NULL));
+    
+    CHK(munmap(uffd->addr, (uffd->num_segs * uffd->seg_size)));
+    CHK(close(uffd->uffd));
+    CHK(close(uffd->wake_fd[0]));
+    CHK(close(uffd->wake_fd[1]));
+    CHK(pthread_mutex_destroy(&uffd->mutex));
+    
+    free(uffd->seg_state);
+    free(uffd->seg_prev);
+    free(uffd->seg_next);
+    free(uffd->buffer);
+    free(uffd);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void uffdStats(uffd_t *uffd, uint32_t *num_reads, uint32_t *num_writes)
+{
+    *num_reads  = uffd->num_reads;
+    *num_writes = uffd->num_writes;
+}
+
+uint32_t uffdFills(uffd_t *uffd)
+{
+    return uffd->num_fills;
+}
+
@@ -0,0 +1,67 @@
+#ifndef _UFFD_H
+#define _UFFD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enumerate that defines the eviction policy of the userfaultfd pager.
+ */
+typedef enum
+{
+    UFFD_PTYPE_FIFO = 0,
+    UFFD_PTYPE_LRU
+} uffdptype_t;
+
+/**
+ * Opaque structure that represents a mapping serviced by the userfaultfd
+ * pager (i.e., one fault-servicing thread per mapping).
+ */
+typedef struct uffd uffd_t;
+
+/**
+ * Helper method that creates a mapping backed by a file, where the segments
+ * are filled on-demand from the file (UFFDIO_COPY) and written back on
+ * eviction or synchronization. The budget limits the resident memory of the
+ * mapping, in bytes (zero means unlimited), and requires the write-protect
+ * mode of userfaultfd (i.e., ENOTSUP otherwise).
+ */
+int uffdMap(size_t size, size_t seg_size, int fd, off_t offset, size_t budget,
+            int8_t read_file, uffdptype_t ptype, uffd_t **uffd, void **addr);
+
+/**
+ * Helper method that writes back the dirty segments of the mapping.
+ */
+int uffdSync(uffd_t *uffd);
+
+/**
+ * Helper method that changes the budget of the mapping, in bytes (zero means
+ * unlimited). The segments above the new budget are evicted immediately.
+ */
+int uffdSetBudget(uffd_t *uffd, size_t budget);
+
+/**
+ * Helper method that releases the mapping, optionally writing back the dirty
+ * segments before.
+ */
+int uffdUnmap(uffd_t *uffd, int8_t sync);
+
+/**
+ * Helper method that returns the number of segments read from / written to
+ * the file by the pager.
+ */
+void uffdStats(uffd_t *uffd, uint32_t *num_reads, uint32_t *num_writes);
+
+/**
+ * Helper method that returns the number of segments filled by the pager
+ * (i.e., either read from the file or zero-filled).
+ */
+uint32_t uffdFills(uffd_t *uffd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
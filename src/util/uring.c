@@ -0,0 +1,289 @@
+#include "common.h"
+#include "uring.h"
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#define URING_ALIGNMENT 4096
+
+/**
+ * Helper method that submits the queued operations, optionally waiting for a
+ * minimum number of completions.
+ */
+static int uringEnter(uring_t *uring, uint32_t min_complete) __CHK_FN__
+{
+    const uint32_t flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+    int            ret   = 0;
+    
+    do
+    {
+        ret = syscall(__NR_io_uring_enter, uring->ring_fd, uring->num_queued,
+                      min_complete, flags, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    
+    CHKB((ret < 0), errno);
+    uring->num_queued -= ret;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that processes the available completions, returning the
+ * staging buffers to the list of free buffers.
+ */
+static int uringReap(uring_t *uring, uint32_t *num_reaped) __CHK_FN__
+{
+    uint32_t head = *uring->cq_head;
+    uint32_t tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+    
+    for (*num_reaped = 0; head != tail; head++, (*num_reaped)++)
+    {
+        const struct io_uring_cqe *cqe  = &uring->cqes[head & *uring->cq_mask];
+        const uint32_t            slot  = (uint32_t)cqe->user_data;
+        
+        CHKB((cqe->res < 0), -cqe->res);
+        CHKB(((uint32_t)cqe->res != uring->slot_length[slot]), EIO);
+        
+        if (uring->hist != NULL && uring->slot_start[slot] > 0)
+        {
+            histRecord(&uring->hist[(uring->slot_write[slot]) ? HIST_WRITE :
+                                                                HIST_READ],
+                       (histGetTime() - uring->slot_start[slot]));
+        }
+        
+        uring->free_slots[uring->num_free++] = slot;
+    }
+    
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that waits until, at least, the given number of operations
+ * have completed.
+ */
+static int uringWait(uring_t *uring, uint32_t min_complete) __CHK_FN__
+{
+    uint32_t num_reaped = 0;
+    
+    CHK(uringReap(uring, &num_reaped));
+    
+    while (num_reaped < min_complete)
+    {
+        uint32_t num_reaped_i = 0;
+        
+        CHK(uringEnter(uring, (min_complete - num_reaped)));
+        CHK(uringReap(uring, &num_reaped_i));
+        num_reaped += num_reaped_i;
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uringInit(uring_t *uring, int fd, uint32_t queue_depth, uint32_t batch,
+              size_t buffer_size, int flags) __CHK_FN__
+{
+    struct io_uring_params params = { 0 };
+    
+    memset(uring, 0, sizeof(uring_t));
+    
+    uring->fd          = fd;
+    uring->flags       = flags;
+    uring->queue_depth = (queue_depth > 0) ? queue_depth : 1;
+    uring->batch       = (batch > 0 && batch <= uring->queue_depth) ?
+                         batch : uring->queue_depth;
+    uring->buffer_size = ((buffer_size + URING_ALIGNMENT - 1) /
+                          URING_ALIGNMENT) * URING_ALIGNMENT;
+    uring->ring_fd     = syscall(__NR_io_uring_setup, uring->queue_depth,
+                                 &params);
+    CHKB((uring->ring_fd < 0), errno);
+    
+    // Map the submission / completion rings and the submission entries
+    uring->sq_size   = params.sq_off.array + params.sq_entries *
+                                             sizeof(uint32_t);
+    uring->cq_size   = params.cq_off.cqes  + params.cq_entries *
+                                             sizeof(struct io_uring_cqe);
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        uring->sq_size = (uring->cq_size > uring->sq_size) ? uring->cq_size :
+                                                             uring->sq_size;
+    }
+    
+    uring->sq_ptr = mmap(NULL, uring->sq_size, (PROT_READ | PROT_WRITE),
+                         (MAP_SHARED | MAP_POPULATE), uring->ring_fd,
+                         IORING_OFF_SQ_RING);
+    CHKB((uring->sq_ptr == MAP_FAILED), errno);
+    
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        uring->cq_ptr = uring->sq_ptr;
+    }
+    else
+    {
+        uring->cq_ptr = mmap(NULL, uring->cq_size, (PROT_READ | PROT_WRITE),
+                             (MAP_SHARED | MAP_POPULATE), uring->ring_fd,
+                             IORING_OFF_CQ_RING);
+        CHKB((uring->cq_ptr == MAP_FAILED), errno);
+    }
+    
+    uring->sqes = mmap(NULL, uring->sqes_size, (PROT_READ | PROT_WRITE),
+                       (MAP_SHARED | MAP_POPULATE), uring->ring_fd,
+                       IORING_OFF_SQES);
+    CHKB((uring->sqes == MAP_FAILED), errno);
+    
+    uring->sq_head  = (uint32_t *)((char *)uring->sq_ptr + params.sq_off.head);
+    uring->sq_tail  = (uint32_t *)((char *)uring->sq_ptr + params.sq_off.tail);
+    uring->sq_mask  = (uint32_t *)((char *)uring->sq_ptr +
+                                   params.sq_off.ring_mask);
+    uring->sq_array = (uint32_t *)((char *)uring->sq_ptr + params.sq_off.array);
+    uring->cq_head  = (uint32_t *)((char *)uring->cq_ptr + params.cq_off.head);
+    uring->cq_tail  = (uint32_t *)((char *)uring->cq_ptr + params.cq_off.tail);
+    uring->cq_mask  = (uint32_t *)((char *)uring->cq_ptr +
+                                   params.cq_off.ring_mask);
+    uring->cqes     = (struct io_uring_cqe *)((char *)uring->cq_ptr +
+                                              params.cq_off.cqes);
+    
+    // Allocate the staging buffers (aligned, as required for O_DIRECT)
+    CHK(posix_memalign((void **)&uring->buffers, URING_ALIGNMENT,
+                       (uring->buffer_size * uring->queue_depth)));
+    memset(uring->buffers, 0, (uring->buffer_size * uring->queue_depth));
+    
+    uring->free_slots  = (uint32_t *)malloc(sizeof(uint32_t) *
+                                            uring->queue_depth);
+    uring->slot_start  = (uint64_t *)calloc(uring->queue_depth,
+                                            sizeof(uint64_t));
+    uring->slot_write  = (uint8_t *)calloc(uring->queue_depth,
+                                           sizeof(uint8_t));
+    uring->slot_length = (uint32_t *)calloc(uring->queue_depth,
+                                            sizeof(uint32_t));
+    
+    for (uint32_t slot = 0; slot < uring->queue_depth; slot++)
+    {
+        uring->free_slots[uring->num_free++] = slot;
+    }
+    
+    // Register the staging buffers and / or the file, if requested
+    if (flags & URING_FIXED_BUFFERS)
+    {
+        struct iovec *iov = (struct iovec *)malloc(sizeof(struct iovec) *
+                                                   uring->queue_depth);
+        
+        for (uint32_t slot = 0; slot < uring->queue_depth; slot++)
+        {
+            iov[slot].iov_base = &uring->buffers[slot * uring->buffer_size];
+            iov[slot].iov_len  = uring->buffer_size;
+        }
+        
+        CHKB((syscall(__NR_io_uring_register, uring->ring_fd,
+                      IORING_REGISTER_BUFFERS, iov, uring->queue_depth) < 0),
+             errno);
+        free(iov);
+    }
+    
+    if (flags & URING_FIXED_FILE)
+    {
+        CHKB((syscall(__NR_io_uring_register, uring->ring_fd,
+                      IORING_REGISTER_FILES, &uring->fd, 1) < 0), errno);
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uringSubmit(uring_t *uring, off_t offset, const void *buffer,
+                size_t length, int is_write) __CHK_FN__
+{
+    const int           is_fixed = (uring->flags & URING_FIXED_BUFFERS);
+    char                *staging = NULL;
+    uint32_t            tail     = 0;
+    uint32_t            index    = 0;
+    uint32_t            slot     = 0;
+    struct io_uring_sqe *sqe     = NULL;
+    
+    // The operations must fit in a staging buffer
+    CHKB((length > uring->buffer_size), EINVAL);
+    
+    // Wait for a staging buffer, if all of them are in-flight
+    if (uring->num_free == 0)
+    {
+        CHK(uringWait(uring, 1));
+    }
+    
+    slot    = uring->free_slots[--uring->num_free];
+    tail    = *uring->sq_tail;
+    index   = tail & *uring->sq_mask;
+    sqe     = &uring->sqes[index];
+    staging = &uring->buffers[slot * uring->buffer_size];
+    
+    // The data of the writes is staged, as the buffer might be reused
+    if (is_write)
+    {
+        memcpy(staging, buffer, length);
+    }
+    
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode    = (is_write) ? ((is_fixed) ? IORING_OP_WRITE_FIXED :
+                                                IORING_OP_WRITE) :
+                                  ((is_fixed) ? IORING_OP_READ_FIXED :
+                                                IORING_OP_READ);
+    sqe->fd        = (uring->flags & URING_FIXED_FILE) ? 0 : uring->fd;
+    sqe->flags     = (uring->flags & URING_FIXED_FILE) ? IOSQE_FIXED_FILE : 0;
+    sqe->off       = offset;
+    sqe->addr      = (uintptr_t)staging;
+    sqe->len       = length;
+    sqe->buf_index = (is_fixed) ? slot : 0;
+    sqe->user_data = slot;
+    
+    uring->slot_start[slot]  = (uring->hist != NULL) ? histGetTime() : 0;
+    uring->slot_write[slot]  = is_write;
+    uring->slot_length[slot] = length;
+    uring->sq_array[index]   = index;
+    __atomic_store_n(uring->sq_tail, (tail + 1), __ATOMIC_RELEASE);
+    
+    // Submit the operations once the batch is complete
+    if (++uring->num_queued >= uring->batch)
+    {
+        CHK(uringEnter(uring, 0));
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uringDrain(uring_t *uring) __CHK_FN__
+{
+    CHK(uringEnter(uring, 0));
+    CHK(uringWait(uring, (uring->queue_depth - uring->num_free)));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uringSync(uring_t *uring) __CHK_FN__
+{
+    CHK(uringDrain(uring));
+    CHK(fsync(uring->fd));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int uringFree(uring_t *uring) __CHK_FN__
+{
+    CHK(munmap(uring->sqes, uring->sqes_size));
+    
+    if (uring->cq_ptr != uring->sq_ptr)
+    {
+        CHK(munmap(uring->cq_ptr, uring->cq_size));
+    }
+    
+    CHK(munmap(uring->sq_ptr, uring->sq_size));
+    CHK(close(uring->ring_fd));
+    
+    free(uring->buffers);
+    free(uring->free_slots);
+    free(uring->slot_start);
+    free(uring->slot_write);
+    free(uring->slot_length);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
@@ -0,0 +1,89 @@
+#ifndef _URING_H
+#define _URING_H
+
+#include "hist.h"
+#include <linux/io_uring.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define URING_FIXED_BUFFERS 0x1
+#define URING_FIXED_FILE    0x2
+
+/**
+ * Structure that represents an io_uring instance with its own set of staging
+ * buffers (i.e., one buffer for each operation that can be in-flight).
+ */
+typedef struct
+{
+    int                 ring_fd;
+    int                 fd;
+    int                 flags;
+    uint32_t            queue_depth;
+    uint32_t            batch;
+    uint32_t            num_queued;
+    uint32_t            num_free;
+    uint32_t            *free_slots;
+    uint64_t            *slot_start;
+    uint8_t             *slot_write;
+    uint32_t            *slot_length;
+    char                *buffers;
+    size_t              buffer_size;
+    hist_t              *hist;
+    void                *sq_ptr;
+    void                *cq_ptr;
+    size_t              sq_size;
+    size_t              cq_size;
+    uint32_t            *sq_head;
+    uint32_t            *sq_tail;
+    uint32_t            *sq_mask;
+    uint32_t            *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t              sqes_size;
+    uint32_t            *cq_head;
+    uint32_t            *cq_tail;
+    uint32_t            *cq_mask;
+    struct io_uring_cqe *cqes;
+} uring_t;
+
+/**
+ * Helper method that creates an io_uring instance over a file. The flags
+ * allow to register the staging buffers and / or the file in the kernel.
+ */
+int uringInit(uring_t *uring, int fd, uint32_t queue_depth, uint32_t batch,
+              size_t buffer_size, int flags);
+
+/**
+ * Helper method that queues a read / write operation. The buffer is copied
+ * into a staging buffer on the writes, while the reads land on the staging
+ * buffer (i.e., longer operations are rejected). The operations are
+ * submitted in batches, and the call only blocks if all the staging buffers
+ * are in-flight. If a histogram is set, the latency of each operation is
+ * recorded on completion.
+ */
+int uringSubmit(uring_t *uring, off_t offset, const void *buffer,
+                size_t length, int is_write);
+
+/**
+ * Helper method that submits the queued operations and waits for all the
+ * in-flight operations to complete.
+ */
+int uringDrain(uring_t *uring);
+
+/**
+ * Helper method that drains the ring and synchronizes the file with storage.
+ */
+int uringSync(uring_t *uring);
+
+/**
+ * Helper method that releases an io_uring instance.
+ */
+int uringFree(uring_t *uring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -2,6 +2,8 @@
 #include "common.h"
 #include "util.h"
 
+#define CACHE_CHUNK 1048576 // Bytes per write / read to set the cache state
+
 int createDir(const char *path) __CHK_FN__
 {
     struct stat st = { 0 };
@@ -46,9 +48,257 @@ int openFile(const char *filename, int flags, int8_t preallocate, size_t size,
     return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
 }
 
+int setCacheState(int fd, off_t offset, size_t size,
+                  cachestate_t state) __CHK_FN__
+{
+    char *buffer = NULL;
+    
+    if (state != CACHE_DEFAULT)
+    {
+        buffer = (char *)malloc(CACHE_CHUNK);
+        memset(buffer, 21, CACHE_CHUNK);
+        
+        for (size_t i = 0; i < size; i += CACHE_CHUNK)
+        {
+            const size_t length = ((i + CACHE_CHUNK) > size) ? (size - i) :
+                                                             CACHE_CHUNK;
+            
+            CHKB((pwrite(fd, buffer, length, (offset + i)) != length), EIO);
+        }
+        
+        CHK(fsync(fd));
+    }
+    
+    if (state == CACHE_COLD)
+    {
+        CHK(posix_fadvise(fd, offset, size, POSIX_FADV_DONTNEED));
+    }
+    
+    // Read the region back, in case that part of it was already evicted
+    if (state == CACHE_WARM)
+    {
+        for (size_t i = 0; i < size; i += CACHE_CHUNK)
+        {
+            const size_t length = ((i + CACHE_CHUNK) > size) ? (size - i) :
+                                                             CACHE_CHUNK;
+            
+            CHKB((pread(fd, buffer, length, (offset + i)) != length), EIO);
+        }
+    }
+    
+    free(buffer);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+/**
+ * Helper method that returns a field of /proc/meminfo in bytes (e.g., the
+ * "Hugepagesize" field), or zero if the field is not found.
+ */
+static size_t getMeminfo(const char *field)
+{
+    FILE   *file = fopen("/proc/meminfo", "r");
+    char   line[256];
+    char   name[64];
+    size_t size  = 0;
+    
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "%63[^:]: %zu kB", name, &size) == 2 &&
+            !strcmp(name, field))
+        {
+            break;
+        }
+        
+        size = 0;
+    }
+    
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    
+    return (size << 10);
+}
+
+/**
+ * Helper method that returns the size of the hugetlbfs pages (default size).
+ */
+static size_t getHugePageSize(void)
+{
+    const size_t size = getMeminfo("Hugepagesize");
+    
+    return (size > 0) ? size : (2 << 20);
+}
+
+/**
+ * Helper method that applies the hints of the variant to a mapping, in order
+ * (i.e., the huge pages before the read-ahead).
+ */
+static int adviseMemory(void *addr, size_t size, int variant) __CHK_FN__
+{
+    const int advice[4][2] = { { MAPVAR_THP,        MADV_HUGEPAGE   },
+                               { MAPVAR_SEQUENTIAL, MADV_SEQUENTIAL },
+                               { MAPVAR_RANDOM,     MADV_RANDOM     },
+                               { MAPVAR_WILLNEED,   MADV_WILLNEED   } };
+    
+    for (int i = 0; i < 4; i++)
+    {
+        if (variant & advice[i][0])
+        {
+            CHKB(madvise(addr, size, advice[i][1]), errno);
+        }
+    }
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mapMemory(size_t size, int prot, int flags, int fd, off_t offset,
+              int variant, void **addr) __CHK_FN__
+{
+    if (variant & MAPVAR_HUGETLB)
+    {
+        const size_t hpage_size = getHugePageSize();
+        
+        // The pages are reserved, so that the call fails if the pool is not
+        // large enough (instead of raising SIGBUS on the first access)
+        CHKB(!(flags & MAP_ANONYMOUS), EINVAL);
+        size  = ((size + hpage_size - 1) / hpage_size) * hpage_size;
+        flags = (flags & ~MAP_NORESERVE) | MAP_HUGETLB;
+    }
+    
+    flags |= (variant & MAPVAR_POPULATE) ? MAP_POPULATE : 0;
+    
+    *addr = mmap(NULL, size, prot, flags, fd, offset);
+    CHKB((*addr == MAP_FAILED), errno);
+    
+    CHK(adviseMemory(*addr, size, variant));
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int mapInterleaved(size_t size, int prot, int flags, int fd, off_t offset,
+                   size_t block_size, off_t block_stride, int variant,
+                   void **addr) __CHK_FN__
+{
+    char *baseptr = NULL;
+    
+    CHKB((variant & MAPVAR_HUGETLB), EINVAL);
+    flags |= (variant & MAPVAR_POPULATE) ? MAP_POPULATE : 0;
+    
+    // Reserve the range first, so that the blocks are contiguous in memory
+    baseptr = (char *)mmap(NULL, size, PROT_NONE, (MAP_PRIVATE | MAP_ANONYMOUS |
+                                                   MAP_NORESERVE), -1, 0);
+    CHKB((baseptr == MAP_FAILED), errno);
+    
+    for (size_t block = 0; (block * block_size) < size; block++)
+    {
+        const size_t length = ((block + 1) * block_size > size) ?
+                              (size - block * block_size) : block_size;
+        
+        CHKB((mmap(&baseptr[block * block_size], length, prot,
+                   (flags | MAP_FIXED), fd,
+                   (offset + block * block_stride)) == MAP_FAILED), errno);
+    }
+    
+    CHK(adviseMemory(baseptr, size, variant));
+    *addr = baseptr;
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int unmapMemory(void *addr, size_t size, int variant) __CHK_FN__
+{
+    if (variant & MAPVAR_HUGETLB)
+    {
+        const size_t hpage_size = getHugePageSize();
+        size = ((size + hpage_size - 1) / hpage_size) * hpage_size;
+    }
+    
+    CHKB(munmap(addr, size), errno);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+void *allocBuffer(size_t size)
+{
+    void *buffer = NULL;
+    
+    if (posix_memalign(&buffer, sysconf(_SC_PAGESIZE), size))
+    {
+        buffer = NULL;
+    }
+    
+    return buffer;
+}
+
+size_t getMemAvailable(void)
+{
+    return getMeminfo("MemAvailable");
+}
+
+size_t getWriteBytes(void)
+{
+    FILE   *file = fopen("/proc/self/io", "r");
+    char   line[256];
+    size_t size  = 0;
+    
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL &&
+           sscanf(line, "write_bytes: %zu", &size) != 1);
+    
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    
+    return size;
+}
+
+int allocBallast(size_t size, void **addr, int *is_locked) __CHK_FN__
+{
+    *addr = mmap(NULL, size, (PROT_READ | PROT_WRITE),
+                 (MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE), -1, 0);
+    CHKB((*addr == MAP_FAILED), errno);
+    
+    *is_locked = (mlock(*addr, size) == 0);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
+int freeBallast(void *addr, size_t size) __CHK_FN__
+{
+    CHKB(munmap(addr, size), errno);
+    
+    return CHK_SUCCESS(CHK_EMPTY_ERROR_FN);
+}
+
 double getElapsed(timespec_t start, timespec_t stop, tsunit_t unit)
 {
     return (double)((stop.tv_sec  - start.tv_sec) * __UINT64_C(1000000000) +
                     (stop.tv_nsec - start.tv_nsec)) / (double)unit;
 }
 
+size_t getEnvSize(const char *name, size_t value)
+{
+    const char *str = getenv(name);
+    
+    if (str != NULL && *str != '\0')
+    {
+        sscanf(str, "%zu", &value);
+    }
+    
+    return value;
+}
+
+double getEnvDouble(const char *name, double value)
+{
+    const char *str = getenv(name);
+    
+    if (str != NULL && *str != '\0')
+    {
+        sscanf(str, "%lf", &value);
+    }
+    
+    return value;
+}
+
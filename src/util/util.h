@@ -7,6 +7,25 @@ extern "C" {
 
 typedef struct timespec timespec_t;
 
+// Variants of the mmap-based baselines (i.e., can be combined)
+#define MAPVAR_THP        0x01 // Transparent huge pages (MADV_HUGEPAGE)
+#define MAPVAR_HUGETLB    0x02 // hugetlbfs pages (MAP_HUGETLB, anonymous only)
+#define MAPVAR_POPULATE   0x04 // Pre-fault the mapping (MAP_POPULATE)
+#define MAPVAR_SEQUENTIAL 0x08 // Sequential access hint (MADV_SEQUENTIAL)
+#define MAPVAR_RANDOM     0x10 // Random access hint (MADV_RANDOM)
+#define MAPVAR_WILLNEED   0x20 // Read-ahead hint (MADV_WILLNEED)
+
+/**
+ * Enumerate that defines the state of the page cache for a backing file
+ * before the timed iterations.
+ */
+typedef enum
+{
+    CACHE_DEFAULT = 0, // Sparse file, as created (i.e., not controlled)
+    CACHE_COLD,        // Populated, synchronized and evicted from the cache
+    CACHE_WARM         // Populated, synchronized and read back into the cache
+} cachestate_t;
+
 /**
  * Enumerate that defines the time unit between two different time intervals.
  */
@@ -34,11 +53,83 @@ int deleteDir(const char *path);
 int openFile(const char *filename, int flags, int8_t preallocate, size_t size,
              int *fd);
 
+/**
+ * Helper method that sets the page cache state of the given region of the
+ * file. The region is filled with non-zero data first, so that the reads
+ * have to fetch it from storage (i.e., instead of the holes of the file).
+ */
+int setCacheState(int fd, off_t offset, size_t size, cachestate_t state);
+
+/**
+ * Helper method that creates a mapping with the given variant (MAPVAR_*). The
+ * size is rounded up to the huge page size if hugetlbfs pages are requested.
+ */
+int mapMemory(size_t size, int prot, int flags, int fd, off_t offset,
+              int variant, void **addr);
+
+/**
+ * Helper method that creates a contiguous mapping whose blocks are spread
+ * over the file (i.e., the i-th block maps the offset plus i times the
+ * stride). The offset and the size of the blocks must be page-aligned, and
+ * hugetlbfs pages are not supported.
+ */
+int mapInterleaved(size_t size, int prot, int flags, int fd, off_t offset,
+                   size_t block_size, off_t block_stride, int variant,
+                   void **addr);
+
+/**
+ * Helper method that releases a mapping created with the given variant.
+ */
+int unmapMemory(void *addr, size_t size, int variant);
+
+/**
+ * Helper method that allocates a page-aligned buffer (e.g., as required by
+ * O_DIRECT). The buffer is released with free(), and NULL is returned on
+ * failure.
+ */
+void *allocBuffer(size_t size);
+
+/**
+ * Helper method that returns the memory available in the node (i.e., the
+ * MemAvailable estimation of the kernel), in bytes.
+ */
+size_t getMemAvailable(void);
+
+/**
+ * Helper method that returns the bytes written to storage by the process
+ * (i.e., the write_bytes field of /proc/self/io), or zero if not available.
+ */
+size_t getWriteBytes(void);
+
+/**
+ * Helper method that allocates a ballast that reduces the memory available
+ * in the node. The ballast is populated and locked in memory. If it cannot be
+ * locked (e.g., RLIMIT_MEMLOCK), the ballast is kept populated only.
+ */
+int allocBallast(size_t size, void **addr, int *is_locked);
+
+/**
+ * Helper method that releases a ballast.
+ */
+int freeBallast(void *addr, size_t size);
+
 /**
  * Helper method that returns the elapsed time between two time intervals.
  */
 double getElapsed(timespec_t start, timespec_t stop, tsunit_t unit);
 
+/**
+ * Helper method that retrieves an optional numeric setting from the
+ * environment, or the default value if the variable is not defined.
+ */
+size_t getEnvSize(const char *name, size_t value);
+
+/**
+ * Helper method that retrieves an optional floating-point setting from the
+ * environment, or the default value if the variable is not defined.
+ */
+double getEnvDouble(const char *name, double value);
+
 #ifdef __cplusplus
 }
 #endif